@@ -14,6 +14,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stddef.h>
+#include <math.h>
 
 // ----------------- TYPE ALIASES -----------------
 typedef int8_t i8;
@@ -48,12 +49,18 @@ typedef void u0;
     ((out_min) + ((x) - (in_min)) * ((out_max) - (out_min)) / ((in_max) - (in_min)))
 #define LERP(a, b, t) ((a) + (t) * ((b) - (a)))
 
-#define POW(x, n) ({             \
-    u64 _i;                      \
-    i64 _res = 1;                \
-    for (_i = 0; _i < (n); _i++) \
-        _res *= (x);             \
-    _res;                        \
+#define POW(x, n) ({           \
+    u64 _base = (u64)(i64)(x); \
+    u64 _exp = (n);            \
+    u64 _res = 1;              \
+    while (_exp)               \
+    {                          \
+        if (_exp & 1)          \
+            _res *= _base;     \
+        if (_exp >>= 1)        \
+            _base *= _base;    \
+    }                          \
+    (i64) _res;                \
 })
 #define LOG(x, base) (log(x) / log(base))
 
@@ -84,8 +91,151 @@ typedef void u0;
         (b) = tmp;    \
     } while (0)
 
+// ----------------- MATH KERNELS -----------------
+
+#ifdef CHEST_ENABLE_MATH
+
+// integer power by squaring, wraps around on overflow
+static inline u64 ipow(u64 x, u64 n)
+{
+    u64 res = 1;
+    while (n)
+    {
+        if (n & 1)
+            res *= x;
+        if (n >>= 1)
+            x *= x;
+    }
+    return res;
+}
+static inline u64 mulmod(u64 a, u64 b, u64 m)
+{
+    return (u64)((unsigned __int128)a * b % m);
+}
+static inline u64 powmod(u64 b, u64 e, u64 m)
+{
+    u64 res = 1 % m;
+    b %= m;
+    while (e)
+    {
+        if (e & 1)
+            res = mulmod(res, b, m);
+        if (e >>= 1)
+            b = mulmod(b, b, m);
+    }
+    return res;
+}
+
+// floor(log2(x)), x must not be 0
+static inline u32 ilog2(u64 x)
+{
+    return 63 - (u32)__builtin_clzll(x);
+}
+// floor(sqrt(x)) with Newton's method starting above the root
+static inline u64 isqrt(u64 x)
+{
+    if (x < 2)
+        return x;
+
+    u64 r = 1ULL << ((ilog2(x) >> 1) + 1);
+    while (true)
+    {
+        u64 next = (r + x / r) >> 1;
+        if (next >= r)
+            return r;
+        r = next;
+    }
+}
+
+// Barrett reduction for a fixed modulus 1 <= m < 2^62, replaces the division by two multiplications
+typedef struct
+{
+    u64 m;
+    u64 im;
+} Barrett;
+
+static inline Barrett barrett_init(u64 m)
+{
+    return (Barrett){.m = m, .im = UINT64_MAX / m};
+}
+// x mod m for any 64-bit x
+static inline u64 barrett_reduce(const Barrett *br, u64 x)
+{
+    u64 q = (u64)(((unsigned __int128)x * br->im) >> 64);
+    u64 r = x - q * br->m;
+    while (r >= br->m)
+        r -= br->m;
+    return r;
+}
+// a * b mod m, for a, b < m < 2^32
+static inline u64 barrett_mulmod(const Barrett *br, u64 a, u64 b)
+{
+    return barrett_reduce(br, a * b);
+}
+
+// Montgomery arithmetic for a fixed odd modulus m < 2^63,
+// the values passed to mont_mul have to be converted with mont_to first
+typedef struct
+{
+    u64 m;
+    u64 inv; // m * inv == 1 (mod 2^64)
+    u64 r2;  // 2^128 mod m
+} Montgomery;
+
+static inline Montgomery mont_init(u64 m)
+{
+    u64 inv = m;
+    for (i32 i = 0; i < 5; i++)
+        inv *= 2 - m * inv;
+
+    u64 r = (0 - m) % m;
+    return (Montgomery){.m = m, .inv = inv, .r2 = mulmod(r, r, m)};
+}
+static inline u64 mont_reduce(const Montgomery *mg, unsigned __int128 t)
+{
+    u64 q = (u64)t * mg->inv;
+    u64 hi = (u64)(t >> 64);
+    u64 qm = (u64)(((unsigned __int128)q * mg->m) >> 64);
+    return hi >= qm ? hi - qm : hi - qm + mg->m;
+}
+static inline u64 mont_to(const Montgomery *mg, u64 x)
+{
+    return mont_reduce(mg, (unsigned __int128)(x % mg->m) * mg->r2);
+}
+static inline u64 mont_from(const Montgomery *mg, u64 x)
+{
+    return mont_reduce(mg, x);
+}
+static inline u64 mont_mul(const Montgomery *mg, u64 a, u64 b)
+{
+    return mont_reduce(mg, (unsigned __int128)a * b);
+}
+// b^e mod m, takes and returns normal (non-Montgomery) values
+static inline u64 mont_powmod(const Montgomery *mg, u64 b, u64 e)
+{
+    u64 res = mont_to(mg, 1);
+    b = mont_to(mg, b);
+    while (e)
+    {
+        if (e & 1)
+            res = mont_mul(mg, res, b);
+        if (e >>= 1)
+            b = mont_mul(mg, b, b);
+    }
+    return mont_from(mg, res);
+}
+
+#endif // CHEST_ENABLE_MATH
+
 // ----------------- DATA TYPES -----------------
 
+// types that store their data in dynamic arrays
+#if defined(CHEST_ENABLE_FT) || defined(CHEST_ENABLE_ST) || defined(CHEST_ENABLE_CSR) || defined(CHEST_ENABLE_DSU)
+#ifndef CHEST_ENABLE_DA
+#define CHEST_ENABLE_DA
+#endif
+#endif
+
 #ifdef CHEST_ENABLE_DA
 typedef struct
 {
@@ -290,7 +440,7 @@ typedef LL(b8) LL_b8;
 
 #endif // CHEST_ENABLE_LL
 
-#ifdef CHEST_ENABLE_HM
+#if defined(CHEST_ENABLE_HM) || defined(CHEST_ENABLE_HS) || defined(CHEST_ENABLE_OHM)
 
 typedef u8 HM_State;
 typedef u64 (*HM_HashFn)(const void *key);
@@ -303,45 +453,6 @@ enum
     HM_TOMBSTONE
 };
 
-typedef struct
-{
-    u64 cap;
-    u64 len;
-    HM_HashFn hash_fn;
-    HM_EqualFn equal_fn;
-} HM_Generic;
-
-#define HM_ENTRY(K, V)  \
-    struct              \
-    {                   \
-        K key;          \
-        V value;        \
-        HM_State state; \
-    }
-#define HM(K, V)               \
-    struct                     \
-    {                          \
-        HM_Generic g;          \
-        HM_ENTRY(K, V) * data; \
-    }
-#define HM_Iter(map) typeof((map).data)
-
-static u64 hm_probe(HM_Generic *hm, void *data, size_t entry_size, size_t key_offset, size_t state_offset, u64 hash, void *key, bool *found);
-static bool hm_grow(HM_Generic *hm, void **pdata, size_t entry_size, size_t key_offset, size_t val_offset, size_t state_offset);
-
-bool _hm_init(void *hm, void **pdata, size_t entry_size, HM_HashFn hash_fn, HM_EqualFn equal_fn);
-bool _hm_reserve(void *hm, void **pdata, size_t entry_size, size_t key_offset, size_t val_offset, size_t state_offset, u64 new_cap);
-void *_hm_get(void *hm, void *data, size_t entry_size, size_t key_offset, size_t val_offset, size_t state_offset, u64 hash, void *key);
-bool _hm_put(void *hm, void **pdata, size_t entry_size, size_t key_offset, size_t key_size, size_t val_offset, size_t val_size, size_t state_offset, u64 hash, void *key, void *val);
-bool _hm_remove(void *hm, void *data, size_t entry_size, size_t key_offset, size_t state_offset, u64 hash, void *key);
-void _hm_clear(void *hm, void *data, size_t entry_size, size_t state_offset);
-void _hm_free(void *hm, void **pdata);
-
-#define HM_TYPE(K, V) HM_##K##_##V
-#define HM_GENERATE_MAP_TYPE(K, V)  \
-    typedef HM(K, V) HM_TYPE(K, V); \
-    typedef typeof(((HM_TYPE(K, V) *)0)->data) HM_Iter_##K##_##V
-
 #define HM_GENERATE_SCALAR_FUNCS(T)                               \
     static inline u64 hm_hash_##T(const void *k)                  \
     {                                                             \
@@ -385,9 +496,73 @@ void _hm_free(void *hm, void **pdata);
         return memcmp(a, b, sizeof(T)) == 0;                      \
     }
 
+#endif // CHEST_ENABLE_HM || CHEST_ENABLE_HS || CHEST_ENABLE_OHM
+
+#ifdef CHEST_ENABLE_HM
+
+// number of old buckets moved per operation while an incremental resize is in progress
+#ifndef CHEST_HM_REHASH_STEP
+#define CHEST_HM_REHASH_STEP 64
+#endif
+
+typedef struct
+{
+    u64 cap;
+    u64 len;
+    HM_HashFn hash_fn;
+    HM_EqualFn equal_fn;
+
+    // incremental resize: the previous table stays alive until every bucket has been moved
+    bool incremental;
+    void *old_data;
+    u64 old_cap;
+    u64 rehash_pos;
+} HM_Generic;
+
+#define HM_ENTRY(K, V)  \
+    struct              \
+    {                   \
+        K key;          \
+        V value;        \
+        HM_State state; \
+    }
+#define HM(K, V)               \
+    struct                     \
+    {                          \
+        HM_Generic g;          \
+        HM_ENTRY(K, V) * data; \
+    }
+#define HM_Iter(map) typeof((map).data)
+
+static u64 hm_probe(HM_Generic *hm, void *data, u64 cap, size_t entry_size, size_t key_offset, size_t state_offset, u64 hash, void *key, bool *found);
+static bool hm_resize(HM_Generic *hm, void **pdata, size_t entry_size, size_t key_offset, size_t state_offset, u64 new_cap);
+static bool hm_grow(HM_Generic *hm, void **pdata, size_t entry_size, size_t key_offset, size_t val_offset, size_t state_offset);
+static void hm_rehash_step(HM_Generic *hm, void *data, size_t entry_size, size_t key_offset, size_t state_offset, u64 steps);
+
+bool _hm_init(void *hm, void **pdata, size_t entry_size, HM_HashFn hash_fn, HM_EqualFn equal_fn);
+bool _hm_reserve(void *hm, void **pdata, size_t entry_size, size_t key_offset, size_t val_offset, size_t state_offset, u64 new_cap);
+void *_hm_get(void *hm, void *data, size_t entry_size, size_t key_offset, size_t val_offset, size_t state_offset, u64 hash, void *key);
+void *_hm_entry(void *hm, void **pdata, size_t entry_size, size_t key_offset, size_t key_size, size_t val_offset, size_t val_size, size_t state_offset, u64 hash, void *key, bool *inserted);
+bool _hm_put(void *hm, void **pdata, size_t entry_size, size_t key_offset, size_t key_size, size_t val_offset, size_t val_size, size_t state_offset, u64 hash, void *key, void *val);
+bool _hm_remove(void *hm, void *data, size_t entry_size, size_t key_offset, size_t state_offset, u64 hash, void *key);
+void _hm_clear(void *hm, void *data, size_t entry_size, size_t state_offset);
+void _hm_free(void *hm, void **pdata);
+void _hm_finish_rehash(void *hm, void *data, size_t entry_size, size_t key_offset, size_t state_offset);
+
+#define HM_TYPE(K, V) HM_##K##_##V
+#define HM_GENERATE_MAP_TYPE(K, V)  \
+    typedef HM(K, V) HM_TYPE(K, V); \
+    typedef typeof(((HM_TYPE(K, V) *)0)->data) HM_Iter_##K##_##V
+
 #define hm_init(hm, hash, eq) \
     _hm_init(&(hm)->g, (void **)&(hm)->data, sizeof((hm)->data[0]), (hash), (eq))
 #define hm_count(hm) ((hm)->g.len)
+#define hm_set_incremental(hm, enabled) ((hm)->g.incremental = (enabled))
+#define hm_is_rehashing(hm) ((hm)->g.old_data != NULL)
+#define hm_finish_rehash(hm)                                     \
+    _hm_finish_rehash(&(hm)->g, (hm)->data, sizeof(*(hm)->data), \
+                      offsetof(typeof(*(hm)->data), key),        \
+                      offsetof(typeof(*(hm)->data), state))
 #define hm_reserve(hm, n) \
     _hm_reserve(&(hm)->g, (void **)&(hm)->data, sizeof(*(hm)->data), offsetof(typeof(*(hm)->data), key), offsetof(typeof(*(hm)->data), value), offsetof(typeof(*(hm)->data), state), (n))
 #define hm_get(hm, k) ({                                        \
@@ -412,6 +587,35 @@ void _hm_free(void *hm, void **pdata);
             offsetof(typeof(*(hm)->data), state), \
             (hm)->g.hash_fn(&_k), &_k, &_v);      \
 })
+// pointer to the value of k, inserting k with a zeroed value first if it is missing (NULL if the allocation fails)
+#define hm_entry(hm, k, inserted) ({                                          \
+    typeof((hm)->data[0].key) _hm_temp_key = (k);                             \
+    (typeof(&(hm)->data[0].value))                                            \
+        _hm_entry(&(hm)->g, (void **)&(hm)->data,                             \
+                  sizeof(*(hm)->data),                                        \
+                  offsetof(typeof(*(hm)->data), key),                         \
+                  sizeof(_hm_temp_key),                                       \
+                  offsetof(typeof(*(hm)->data), value),                       \
+                  sizeof((hm)->data[0].value),                                \
+                  offsetof(typeof(*(hm)->data), state),                       \
+                  (hm)->g.hash_fn(&_hm_temp_key), &_hm_temp_key, (inserted)); \
+})
+#define hm_get_or_insert(hm, k, default_value) ({                          \
+    bool _hm_inserted;                                                     \
+    typeof(&(hm)->data[0].value) _hm_val = hm_entry(hm, k, &_hm_inserted); \
+    if (_hm_val && _hm_inserted)                                           \
+        *_hm_val = (default_value);                                        \
+    _hm_val;                                                               \
+})
+// inserts v if k is missing, otherwise replaces the value with fn(old value, v)
+#define hm_upsert(hm, k, v, fn) ({                                         \
+    typeof((hm)->data[0].value) _hm_new_val = (v);                         \
+    bool _hm_inserted;                                                     \
+    typeof(&(hm)->data[0].value) _hm_val = hm_entry(hm, k, &_hm_inserted); \
+    if (_hm_val)                                                           \
+        *_hm_val = _hm_inserted ? _hm_new_val : fn(*_hm_val, _hm_new_val); \
+    _hm_val != NULL;                                                       \
+})
 #define hm_remove(hm, k) ({                                    \
     typeof((hm)->data[0].key) _hm_temp_key = (k);              \
     _hm_remove(&(hm)->g, (hm)->data, sizeof(*(hm)->data),      \
@@ -424,112 +628,775 @@ void _hm_free(void *hm, void **pdata);
               offsetof(typeof(*(hm)->data), state))
 #define hm_free(hm) \
     _hm_free(&(hm)->g, (void **)&(hm)->data)
-#define hm_iterate(hm, it)              \
-    for (u64 _i = 0;                    \
-         _i < (hm)->g.cap &&            \
-         (((it) = &(hm)->data[_i]), 1); \
-         _i++)                          \
+#define hm_iterate(hm, it)                   \
+    for (u64 _i = (hm_finish_rehash(hm), 0); \
+         _i < (hm)->g.cap &&                 \
+         (((it) = &(hm)->data[_i]), 1);      \
+         _i++)                               \
         if ((it)->state == HM_FILLED)
 
 #endif // CHEST_ENABLE_HM
 
-#ifdef CHEST_IMPLEMENTATION
-
-#ifdef CHEST_ENABLE_DA
+#ifdef CHEST_ENABLE_HS
 
-void _da_init(void *da)
+typedef struct
 {
-    DA_Generic *dag = (DA_Generic *)da;
+    u64 cap;
+    u64 len;
+    HM_HashFn hash_fn;
+    HM_EqualFn equal_fn;
+    HM_State *states;
+} HS_Generic;
 
-    dag->data = NULL;
-    dag->len = 0;
-    dag->cap = 0;
-}
-bool _da_reserve(void *da, u64 item_size, u64 new_cap)
-{
-    DA_Generic *dag = (DA_Generic *)da;
-    if (new_cap <= dag->cap)
-        return true;
+#define HS(K)         \
+    struct            \
+    {                 \
+        HS_Generic g; \
+        K *keys;      \
+    }
 
-    void *new_data = realloc(dag->data, new_cap * item_size);
-    if (!new_data)
-        return false;
+static u64 hs_probe(HS_Generic *hs, void *keys, size_t key_size, u64 hash, void *key, bool *found);
+static bool hs_grow(HS_Generic *hs, void **pkeys, size_t key_size);
+
+bool _hs_init(void *hs, void **pkeys, size_t key_size, HM_HashFn hash_fn, HM_EqualFn equal_fn);
+bool _hs_reserve(void *hs, void **pkeys, size_t key_size, u64 new_cap);
+bool _hs_contains(void *hs, void *keys, size_t key_size, u64 hash, void *key);
+bool _hs_insert(void *hs, void **pkeys, size_t key_size, u64 hash, void *key);
+bool _hs_remove(void *hs, void *keys, size_t key_size, u64 hash, void *key);
+bool _hs_union(void *dst, void **pdst_keys, void *src, void *src_keys, size_t key_size);
+void _hs_intersect(void *dst, void *dst_keys, void *src, void *src_keys, size_t key_size);
+void _hs_clear(void *hs);
+void _hs_free(void *hs, void **pkeys);
+
+#define HS_TYPE(K) HS_##K
+#define HS_GENERATE_SET_TYPE(K) \
+    typedef HS(K) HS_TYPE(K);   \
+    typedef typeof(((HS_TYPE(K) *)0)->keys) HS_Iter_##K
+
+#define hs_init(hs, hash, eq) \
+    _hs_init(&(hs)->g, (void **)&(hs)->keys, sizeof(*(hs)->keys), (hash), (eq))
+#define hs_count(hs) ((hs)->g.len)
+#define hs_reserve(hs, n) \
+    _hs_reserve(&(hs)->g, (void **)&(hs)->keys, sizeof(*(hs)->keys), (n))
+#define hs_contains(hs, k) ({                                    \
+    typeof(*(hs)->keys) _hs_temp_key = (k);                      \
+    _hs_contains(&(hs)->g, (hs)->keys, sizeof(*(hs)->keys),      \
+                 (hs)->g.hash_fn(&_hs_temp_key), &_hs_temp_key); \
+})
+#define hs_insert(hs, k) ({                                         \
+    typeof(*(hs)->keys) _hs_temp_key = (k);                         \
+    _hs_insert(&(hs)->g, (void **)&(hs)->keys, sizeof(*(hs)->keys), \
+               (hs)->g.hash_fn(&_hs_temp_key), &_hs_temp_key);      \
+})
+#define hs_remove(hs, k) ({                                    \
+    typeof(*(hs)->keys) _hs_temp_key = (k);                    \
+    _hs_remove(&(hs)->g, (hs)->keys, sizeof(*(hs)->keys),      \
+               (hs)->g.hash_fn(&_hs_temp_key), &_hs_temp_key); \
+})
+#define hs_union(dst, src)                                              \
+    _hs_union(&(dst)->g, (void **)&(dst)->keys, &(src)->g, (src)->keys, \
+              sizeof(*(dst)->keys))
+#define hs_intersect(dst, src)                                    \
+    _hs_intersect(&(dst)->g, (dst)->keys, &(src)->g, (src)->keys, \
+                  sizeof(*(dst)->keys))
+#define hs_clear(hs) _hs_clear(&(hs)->g)
+#define hs_free(hs) \
+    _hs_free(&(hs)->g, (void **)&(hs)->keys)
+#define hs_iterate(hs, it)              \
+    for (u64 _i = 0;                    \
+         _i < (hs)->g.cap &&            \
+         (((it) = &(hs)->keys[_i]), 1); \
+         _i++)                          \
+        if ((hs)->g.states[_i] == HM_FILLED)
 
-    dag->data = new_data;
-    dag->cap = new_cap;
+#endif // CHEST_ENABLE_HS
 
-    return true;
-}
-bool _da_resize(void *da, u64 item_size, u64 new_len)
+#ifdef CHEST_ENABLE_OHM
+
+// insertion-ordered hash map: the entries live packed in a dense array and the
+// hash table only stores u32 indices into it (0 = empty, 1 = tombstone, i + 2 = entry i)
+enum
 {
-    DA_Generic *dag = (DA_Generic *)da;
+    OHM_SLOT_EMPTY,
+    OHM_SLOT_TOMBSTONE,
+    OHM_SLOT_FIRST
+};
 
-    if (new_len > dag->cap)
-        if (!_da_reserve(da, item_size, new_len))
-            return false;
+typedef struct
+{
+    u64 len;
+    u64 cap;
+    u64 slot_cap;
+    u64 tombstones;
+    u32 *slots;
+    HM_HashFn hash_fn;
+    HM_EqualFn equal_fn;
+} OHM_Generic;
 
-    if (new_len > dag->len)
-    {
-        void *start = (u8 *)dag->data + (dag->len * item_size);
-        memset(start, 0, (new_len - dag->len) * item_size);
+#define OHM_ENTRY(K, V) \
+    struct              \
+    {                   \
+        K key;          \
+        V value;        \
+    }
+#define OHM(K, V)               \
+    struct                      \
+    {                           \
+        OHM_Generic g;          \
+        OHM_ENTRY(K, V) * data; \
     }
-    dag->len = new_len;
 
-    return true;
-}
-bool _da_push(void *da, u64 item_size, void *item)
-{
-    DA_Generic *dag = (DA_Generic *)da;
+static u64 ohm_probe(OHM_Generic *ohm, void *data, size_t entry_size, size_t key_offset, u64 hash, void *key, bool *found);
+static bool ohm_rehash(OHM_Generic *ohm, void *data, size_t entry_size, size_t key_offset, u64 new_slot_cap);
+
+bool _ohm_init(void *ohm, void **pdata, HM_HashFn hash_fn, HM_EqualFn equal_fn);
+bool _ohm_reserve(void *ohm, void **pdata, size_t entry_size, size_t key_offset, u64 new_cap);
+void *_ohm_get(void *ohm, void *data, size_t entry_size, size_t key_offset, size_t val_offset, u64 hash, void *key);
+bool _ohm_put(void *ohm, void **pdata, size_t entry_size, size_t key_offset, size_t key_size, size_t val_offset, size_t val_size, u64 hash, void *key, void *val);
+bool _ohm_remove(void *ohm, void *data, size_t entry_size, size_t key_offset, u64 hash, void *key, bool keep_order);
+void _ohm_clear(void *ohm);
+void _ohm_free(void *ohm, void **pdata);
+
+#define OHM_TYPE(K, V) OHM_##K##_##V
+#define OHM_GENERATE_MAP_TYPE(K, V)   \
+    typedef OHM(K, V) OHM_TYPE(K, V); \
+    typedef typeof(((OHM_TYPE(K, V) *)0)->data) OHM_Iter_##K##_##V
+
+#define ohm_init(ohm, hash, eq) \
+    _ohm_init(&(ohm)->g, (void **)&(ohm)->data, (hash), (eq))
+#define ohm_count(ohm) ((ohm)->g.len)
+#define ohm_reserve(ohm, n) \
+    _ohm_reserve(&(ohm)->g, (void **)&(ohm)->data, sizeof(*(ohm)->data), offsetof(typeof(*(ohm)->data), key), (n))
+#define ohm_at(ohm, i) (&(ohm)->data[i])
+#define ohm_get(ohm, k) ({                                          \
+    typeof((ohm)->data[0].key) _ohm_temp_key = (k);                 \
+    (typeof(&(ohm)->data[0].value))                                 \
+        _ohm_get(&(ohm)->g, (ohm)->data, sizeof(*(ohm)->data),      \
+                 offsetof(typeof(*(ohm)->data), key),               \
+                 offsetof(typeof(*(ohm)->data), value),             \
+                 (ohm)->g.hash_fn(&_ohm_temp_key), &_ohm_temp_key); \
+})
+#define ohm_contains(ohm, k) (ohm_get(ohm, k) != NULL)
+#define ohm_put(ohm, k, v) ({                       \
+    typeof((ohm)->data[0].key) _k = (k);            \
+    typeof((ohm)->data[0].value) _v = (v);          \
+    _ohm_put(&(ohm)->g, (void **)&(ohm)->data,      \
+             sizeof(*(ohm)->data),                  \
+             offsetof(typeof(*(ohm)->data), key),   \
+             sizeof(_k),                            \
+             offsetof(typeof(*(ohm)->data), value), \
+             sizeof(_v),                            \
+             (ohm)->g.hash_fn(&_k), &_k, &_v);      \
+})
+// keeps the insertion order of the remaining entries, O(len + table size)
+#define ohm_remove(ohm, k) ({                                            \
+    typeof((ohm)->data[0].key) _ohm_temp_key = (k);                      \
+    _ohm_remove(&(ohm)->g, (ohm)->data, sizeof(*(ohm)->data),            \
+                offsetof(typeof(*(ohm)->data), key),                     \
+                (ohm)->g.hash_fn(&_ohm_temp_key), &_ohm_temp_key, true); \
+})
+// moves the last entry into the hole, O(1) but breaks insertion order
+#define ohm_swap_remove(ohm, k) ({                                        \
+    typeof((ohm)->data[0].key) _ohm_temp_key = (k);                       \
+    _ohm_remove(&(ohm)->g, (ohm)->data, sizeof(*(ohm)->data),             \
+                offsetof(typeof(*(ohm)->data), key),                      \
+                (ohm)->g.hash_fn(&_ohm_temp_key), &_ohm_temp_key, false); \
+})
+#define ohm_clear(ohm) _ohm_clear(&(ohm)->g)
+#define ohm_free(ohm) \
+    _ohm_free(&(ohm)->g, (void **)&(ohm)->data)
+#define ohm_foreach(ohm, var)                     \
+    for (typeof(*(ohm)->data) *var = (ohm)->data; \
+         var < (ohm)->data + (ohm)->g.len;        \
+         var++)
 
-    if (dag->len >= dag->cap)
-    {
-        u64 new_cap = dag->cap == 0 ? 8 : dag->cap * 2;
-        if (!_da_reserve(da, item_size, new_cap))
-            return false;
-    }
+#endif // CHEST_ENABLE_OHM
 
-    void *dest = (u8 *)dag->data + (dag->len * item_size);
-    memcpy(dest, item, item_size);
-    dag->len++;
+#ifdef CHEST_ENABLE_SNAPSHOT
 
-    return true;
-}
-bool _da_insert(void *da, u64 item_size, u64 index, void *item)
+// snapshots dump the raw storage of a DA or HM to a file, which can later be mmap-ed back
+// read-only without any parsing or copying (POSIX only, plain data items only, no pointers)
+#define SNAPSHOT_MAGIC 0x504e535453454843ULL // "CHESTSNP"
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_DATA_OFFSET 64
+
+enum
 {
-    DA_Generic *dag = (DA_Generic *)da;
+    SNAPSHOT_DA = 1,
+    SNAPSHOT_HM
+};
 
-    if (index > dag->len)
-        return false;
+typedef struct
+{
+    u64 magic;
+    u32 version;
+    u32 kind;
+    u64 item_size;
+    u64 len;
+    u64 cap;
+    u64 hash_id;
+} Snapshot_Header;
 
-    if (dag->len >= dag->cap)
-    {
-        u64 new_cap = dag->cap == 0 ? 8 : dag->cap * 2;
-        if (!_da_reserve(da, item_size, new_cap))
-            return false;
-    }
+typedef struct
+{
+    void *base;
+    u64 size;
+} Snapshot;
 
-    if (index < dag->len)
-    {
-        void *src = (u8 *)dag->data + (index * item_size);
-        void *dest = (u8 *)src + item_size;
-        memmove(dest, src, (dag->len - index) * item_size);
-    }
+bool _snapshot_write(cstr path, Snapshot_Header *header, const void *data);
+const void *_snapshot_open(cstr path, Snapshot_Header *expected, Snapshot *snap);
+void _snapshot_close(Snapshot *snap);
 
-    void *insert_pos = (u8 *)dag->data + (index * item_size);
-    memcpy(insert_pos, item, item_size);
-    dag->len++;
+#define snapshot_close(snap) _snapshot_close((snap))
 
-    return true;
-}
-bool _da_remove_at(void *da, u64 item_size, u64 index)
-{
-    DA_Generic *dag = (DA_Generic *)da;
+#ifdef CHEST_ENABLE_DA
 
-    if (index >= dag->len)
-        return false;
+bool _da_save(void *da, u64 item_size, cstr path);
+bool _da_mmap(void *da, u64 item_size, cstr path, Snapshot *snap);
 
-    if (index < dag->len - 1)
-    {
+#define da_save(da, path) _da_save((da), sizeof(*(da)->data), (path))
+// the DA points into the read-only mapping: do not push to it or free it, close the snapshot instead
+#define da_mmap(da, path, snap) _da_mmap((da), sizeof(*(da)->data), (path), (snap))
+
+#endif // CHEST_ENABLE_DA
+
+#ifdef CHEST_ENABLE_HM
+
+bool _hm_save(void *hm, void *data, size_t entry_size, u64 hash_id, cstr path);
+bool _hm_mmap(void *hm, void **pdata, size_t entry_size, HM_HashFn hash_fn, HM_EqualFn equal_fn, u64 hash_id, cstr path, Snapshot *snap);
+
+// hash_id is any number identifying the hash function, loading fails if it does not match
+#define hm_save(hm, hash_id, path) ({                                       \
+    hm_finish_rehash(hm);                                                   \
+    _hm_save(&(hm)->g, (hm)->data, sizeof(*(hm)->data), (hash_id), (path)); \
+})
+// the map points into the read-only mapping: only use lookups and iteration, close the snapshot instead of freeing it
+#define hm_mmap(hm, hash, eq, hash_id, path, snap) \
+    _hm_mmap(&(hm)->g, (void **)&(hm)->data, sizeof(*(hm)->data), (hash), (eq), (hash_id), (path), (snap))
+
+#endif // CHEST_ENABLE_HM
+
+#endif // CHEST_ENABLE_SNAPSHOT
+
+#if defined(CHEST_ENABLE_FT) || defined(CHEST_ENABLE_ST)
+
+// combine operations for range query structures, MIN and MAX work as well
+#define RQ_ADD(a, b) ((a) + (b))
+#define RQ_SUB(a, b) ((a) - (b))
+#define RQ_MUL(a, b) ((a) * (b))
+#define RQ_XOR(a, b) ((a) ^ (b))
+
+#endif // CHEST_ENABLE_FT || CHEST_ENABLE_ST
+
+#ifdef CHEST_ENABLE_FT
+
+// Fenwick tree (binary indexed tree) over 0-indexed positions, tree.data[0] is unused.
+// COMBINE has to be associative and commutative, prefix queries return IDENTITY for an empty prefix.
+#define FT_GENERATE_TYPE(NAME, T, COMBINE, IDENTITY)                         \
+    typedef struct                                                           \
+    {                                                                        \
+        DA(T) tree;                                                          \
+    } FT_##NAME;                                                             \
+    static inline u64 ft_##NAME##_len(const FT_##NAME *ft)                   \
+    {                                                                        \
+        return ft->tree.len > 0 ? ft->tree.len - 1 : 0;                      \
+    }                                                                        \
+    static inline bool ft_##NAME##_init(FT_##NAME *ft, u64 n)                \
+    {                                                                        \
+        da_init(&ft->tree);                                                  \
+        if (!da_resize(&ft->tree, n + 1))                                    \
+            return false;                                                    \
+        for (u64 i = 0; i <= n; i++)                                         \
+            ft->tree.data[i] = (IDENTITY);                                   \
+        return true;                                                         \
+    }                                                                        \
+    static inline bool ft_##NAME##_build(FT_##NAME *ft, const T *src, u64 n) \
+    {                                                                        \
+        da_init(&ft->tree);                                                  \
+        if (!da_resize(&ft->tree, n + 1))                                    \
+            return false;                                                    \
+        T *tree = ft->tree.data;                                             \
+        tree[0] = (IDENTITY);                                                \
+        if (n > 0)                                                           \
+            memcpy(tree + 1, src, n * sizeof(T));                            \
+        for (u64 i = 1; i <= n; i++)                                         \
+        {                                                                    \
+            u64 parent = i + (i & -i);                                       \
+            if (parent <= n)                                                 \
+                tree[parent] = COMBINE(tree[parent], tree[i]);               \
+        }                                                                    \
+        return true;                                                         \
+    }                                                                        \
+    static inline void ft_##NAME##_update(FT_##NAME *ft, u64 i, T delta)     \
+    {                                                                        \
+        u64 n = ft_##NAME##_len(ft);                                         \
+        T *tree = ft->tree.data;                                             \
+        for (i++; i <= n; i += i & -i)                                       \
+            tree[i] = COMBINE(tree[i], delta);                               \
+    }                                                                        \
+    static inline T ft_##NAME##_prefix(const FT_##NAME *ft, u64 i)           \
+    {                                                                        \
+        const T *tree = ft->tree.data;                                       \
+        T res = (IDENTITY);                                                  \
+        for (; i > 0; i -= i & -i)                                           \
+            res = COMBINE(res, tree[i]);                                     \
+        return res;                                                          \
+    }                                                                        \
+    static inline void ft_##NAME##_free(FT_##NAME *ft)                       \
+    {                                                                        \
+        da_free(&ft->tree);                                                  \
+    }
+
+// range queries over [l, r) for invertible operations, INVERSE(a, b) has to undo COMBINE(b, x) == a
+#define FT_GENERATE_RANGE(NAME, T, INVERSE)                                   \
+    static inline T ft_##NAME##_range(const FT_##NAME *ft, u64 l, u64 r)      \
+    {                                                                         \
+        return INVERSE(ft_##NAME##_prefix(ft, r), ft_##NAME##_prefix(ft, l)); \
+    }
+
+#endif // CHEST_ENABLE_FT
+
+#ifdef CHEST_ENABLE_ST
+
+// iterative bottom-up segment tree, the leaves are stored at tree.data[n .. 2n).
+// COMBINE has to be associative (not necessarily commutative), IDENTITY is its neutral element.
+// COMBINE may be a macro like MIN, so it is never passed arguments with side effects.
+#define ST_GENERATE_TYPE(NAME, T, COMBINE, IDENTITY)                         \
+    typedef struct                                                           \
+    {                                                                        \
+        DA(T) tree;                                                          \
+        u64 n;                                                               \
+    } ST_##NAME;                                                             \
+    static inline u64 st_##NAME##_len(const ST_##NAME *st)                   \
+    {                                                                        \
+        return st->n;                                                        \
+    }                                                                        \
+    static inline bool st_##NAME##_init(ST_##NAME *st, u64 n)                \
+    {                                                                        \
+        da_init(&st->tree);                                                  \
+        st->n = n;                                                           \
+        if (!da_resize(&st->tree, 2 * n))                                    \
+            return false;                                                    \
+        for (u64 i = 0; i < 2 * n; i++)                                      \
+            st->tree.data[i] = (IDENTITY);                                   \
+        return true;                                                         \
+    }                                                                        \
+    static inline bool st_##NAME##_build(ST_##NAME *st, const T *src, u64 n) \
+    {                                                                        \
+        da_init(&st->tree);                                                  \
+        st->n = n;                                                           \
+        if (!da_resize(&st->tree, 2 * n))                                    \
+            return false;                                                    \
+        T *tree = st->tree.data;                                             \
+        if (n > 0)                                                           \
+            memcpy(tree + n, src, n * sizeof(T));                            \
+        for (u64 i = n - 1; n > 0 && i > 0; i--)                             \
+            tree[i] = COMBINE(tree[2 * i], tree[2 * i + 1]);                 \
+        return true;                                                         \
+    }                                                                        \
+    static inline T st_##NAME##_get(const ST_##NAME *st, u64 i)              \
+    {                                                                        \
+        return st->tree.data[st->n + i];                                     \
+    }                                                                        \
+    static inline void st_##NAME##_set(ST_##NAME *st, u64 i, T value)        \
+    {                                                                        \
+        T *tree = st->tree.data;                                             \
+        i += st->n;                                                          \
+        tree[i] = value;                                                     \
+        for (i >>= 1; i > 0; i >>= 1)                                        \
+            tree[i] = COMBINE(tree[2 * i], tree[2 * i + 1]);                 \
+    }                                                                        \
+    static inline T st_##NAME##_query(const ST_##NAME *st, u64 l, u64 r)     \
+    {                                                                        \
+        const T *tree = st->tree.data;                                       \
+        T left = (IDENTITY), right = (IDENTITY);                             \
+        for (l += st->n, r += st->n; l < r; l >>= 1, r >>= 1)                \
+        {                                                                    \
+            if (l & 1)                                                       \
+            {                                                                \
+                left = COMBINE(left, tree[l]);                               \
+                l++;                                                         \
+            }                                                                \
+            if (r & 1)                                                       \
+            {                                                                \
+                r--;                                                         \
+                right = COMBINE(tree[r], right);                             \
+            }                                                                \
+        }                                                                    \
+        return COMBINE(left, right);                                         \
+    }                                                                        \
+    static inline void st_##NAME##_free(ST_##NAME *st)                       \
+    {                                                                        \
+        da_free(&st->tree);                                                  \
+        st->n = 0;                                                           \
+    }
+
+#endif // CHEST_ENABLE_ST
+
+#ifdef CHEST_ENABLE_CSR
+
+// compressed sparse row graph: the targets of node u are targets[offsets[u] .. offsets[u + 1]),
+// the edge weights (if any) are stored in the same order
+typedef struct
+{
+    u32 from;
+    u32 to;
+} CSR_Edge;
+
+#define CSR_WEDGE(W) \
+    struct           \
+    {                \
+        u32 from;    \
+        u32 to;      \
+        W weight;    \
+    }
+
+typedef struct
+{
+    u64 n;
+    u64 m;
+    u64 *offsets;
+    u32 *targets;
+    void *weights;
+} CSR_Generic;
+
+#define CSR(W)        \
+    struct            \
+    {                 \
+        u64 n;        \
+        u64 m;        \
+        u64 *offsets; \
+        u32 *targets; \
+        W *weights;   \
+    }
+
+bool _csr_build(void *csr, u64 n, const void *edges, u64 edge_count, size_t edge_size, size_t weight_offset, size_t weight_size);
+bool _csr_reverse(void *dst, const void *src, size_t weight_size);
+void _csr_free(void *csr);
+
+// unweighted graphs have an incomplete weight type, so using their weights does not compile
+typedef struct CSR_NoWeight CSR_NoWeight;
+typedef CSR(CSR_NoWeight) CSR_Graph;
+
+#define CSR_TYPE(W) CSR_##W
+#define CSR_GENERATE_GRAPH_TYPE(W) \
+    typedef CSR(W) CSR_TYPE(W);    \
+    typedef CSR_WEDGE(W) CSR_WEdge_##W
+
+// edges is a DA of CSR_Edge (unweighted) or of CSR_WEDGE(W) (weighted), n is the number of nodes
+#define csr_build(csr, n, edges) \
+    _csr_build((csr), (n), (edges)->data, (edges)->len, sizeof(*(edges)->data), 0, 0)
+#define csr_build_weighted(csr, n, edges)                                       \
+    _csr_build((csr), (n), (edges)->data, (edges)->len, sizeof(*(edges)->data), \
+               offsetof(typeof(*(edges)->data), weight), sizeof(*(csr)->weights))
+// dst gets every edge of src flipped (with the same weights for weighted graphs)
+#define csr_reverse(dst, src) _csr_reverse((dst), (src), 0)
+#define csr_reverse_weighted(dst, src) _csr_reverse((dst), (src), sizeof(*(src)->weights))
+#define csr_free(csr) _csr_free((csr))
+#define csr_node_count(csr) ((csr)->n)
+#define csr_edge_count(csr) ((csr)->m)
+#define csr_degree(csr, u) ((csr)->offsets[(u) + 1] - (csr)->offsets[(u)])
+#define csr_neighbors(csr, u) (&(csr)->targets[(csr)->offsets[(u)]])
+#define csr_weights(csr, u) (&(csr)->weights[(csr)->offsets[(u)]])
+#define csr_foreach_neighbor(csr, u, var)                            \
+    for (u32 *var = &(csr)->targets[(csr)->offsets[(u)]],            \
+             *_end_##var = &(csr)->targets[(csr)->offsets[(u) + 1]]; \
+         var < _end_##var;                                           \
+         var++)
+// the edge index (for csr_weights, or any per-edge data) of a neighbor pointer from csr_foreach_neighbor
+#define csr_edge_index(csr, ptr) ((u64)((ptr) - (csr)->targets))
+
+#endif // CHEST_ENABLE_CSR
+
+#ifdef CHEST_ENABLE_BT
+
+// B+ tree map: all entries live in the leaves, which are linked for in-order iteration.
+// Removing borrows from or merges with a sibling when a node drops below half full.
+
+// bytes of keys per node, a few cache lines so that a node is searched with few misses
+#ifndef CHEST_BT_NODE_KEY_BYTES
+#define CHEST_BT_NODE_KEY_BYTES 256
+#endif
+
+typedef i32 (*BT_CmpFn)(const void *a, const void *b);
+
+typedef struct
+{
+    void *next; // next leaf
+    u16 len;
+    b8 leaf;
+} BT_Node;
+
+// node layout: BT_Node header, order keys, then order values (leaf) or order + 1 children (internal)
+#define BT_KEYS_OFFSET ALIGN_UP_POW2(sizeof(BT_Node), 16)
+
+typedef struct
+{
+    void *root;
+    u64 len;
+    BT_CmpFn cmp_fn;
+    u64 key_size;
+    u64 val_size;
+    u64 order;
+    u64 payload_offset;
+} BT_Generic;
+
+typedef struct
+{
+    void *leaf; // NULL once the iterator is past the last entry
+    u64 idx;
+} BT_Iter;
+
+#define BT(K, V)       \
+    struct             \
+    {                  \
+        BT_Generic g;  \
+        K *key_type;   \
+        V *value_type; \
+    }
+#define BT_ENTRY(K, V) \
+    struct             \
+    {                  \
+        K key;         \
+        V value;       \
+    }
+
+static BT_Node *bt_node_new(BT_Generic *bt, bool leaf);
+static void bt_node_free(BT_Generic *bt, BT_Node *node);
+static u64 bt_search(BT_Generic *bt, BT_Node *node, const void *key, bool upper);
+static bool bt_split_child(BT_Generic *bt, BT_Node *parent, u64 i);
+static void bt_fix_child(BT_Generic *bt, BT_Node *parent, u64 i);
+static bool bt_remove_from(BT_Generic *bt, BT_Node *node, const void *key);
+static BT_Node *bt_find_leaf(BT_Generic *bt, const void *key);
+static void bt_iter_settle(BT_Iter *it);
+
+void _bt_init(void *bt, u64 key_size, u64 val_size, BT_CmpFn cmp_fn);
+void *_bt_get(void *bt, const void *key);
+void *_bt_entry(void *bt, const void *key, bool *inserted);
+bool _bt_put(void *bt, const void *key, const void *val);
+bool _bt_remove(void *bt, const void *key);
+bool _bt_bulk_load(void *bt, const void *entries, u64 count, size_t entry_size, size_t key_offset, size_t val_offset);
+BT_Iter _bt_first(void *bt);
+BT_Iter _bt_lower_bound(void *bt, const void *key);
+BT_Iter _bt_upper_bound(void *bt, const void *key);
+void _bt_iter_next(void *bt, BT_Iter *it);
+void *_bt_iter_key(void *bt, BT_Iter it);
+void *_bt_iter_value(void *bt, BT_Iter it);
+bool _bt_iter_before(void *bt, BT_Iter it, const void *key);
+void _bt_free(void *bt);
+
+#define BT_TYPE(K, V) BT_##K##_##V
+#define BT_GENERATE_MAP_TYPE(K, V)  \
+    typedef BT(K, V) BT_TYPE(K, V); \
+    typedef BT_ENTRY(K, V) BT_Entry_##K##_##V
+
+#define BT_GENERATE_SCALAR_FUNCS(T)                            \
+    static inline i32 bt_cmp_##T(const void *a, const void *b) \
+    {                                                          \
+        T x = *(const T *)a;                                   \
+        T y = *(const T *)b;                                   \
+        return (x > y) - (x < y);                              \
+    }
+#define BT_GENERATE_CSTR_FUNCS()                                \
+    static inline i32 bt_cmp_cstr(const void *a, const void *b) \
+    {                                                           \
+        return strcmp(*(char *const *)a, *(char *const *)b);    \
+    }
+
+#define bt_init(bt, cmp) \
+    _bt_init(&(bt)->g, sizeof(*(bt)->key_type), sizeof(*(bt)->value_type), (cmp))
+#define bt_count(bt) ((bt)->g.len)
+#define bt_get(bt, k) ({                                        \
+    typeof(*(bt)->key_type) _bt_temp_key = (k);                 \
+    (typeof((bt)->value_type))_bt_get(&(bt)->g, &_bt_temp_key); \
+})
+#define bt_contains(bt, k) (bt_get(bt, k) != NULL)
+// pointer to the value of k, inserting k with a zeroed value first if it is missing (NULL if the allocation fails)
+#define bt_entry(bt, k, inserted) ({                                          \
+    typeof(*(bt)->key_type) _bt_temp_key = (k);                               \
+    (typeof((bt)->value_type))_bt_entry(&(bt)->g, &_bt_temp_key, (inserted)); \
+})
+#define bt_put(bt, k, v) ({             \
+    typeof(*(bt)->key_type) _k = (k);   \
+    typeof(*(bt)->value_type) _v = (v); \
+    _bt_put(&(bt)->g, &_k, &_v);        \
+})
+#define bt_remove(bt, k) ({                     \
+    typeof(*(bt)->key_type) _bt_temp_key = (k); \
+    _bt_remove(&(bt)->g, &_bt_temp_key);        \
+})
+// entries is a DA of BT_ENTRY(K, V) sorted by strictly increasing keys, the tree has to be empty
+#define bt_bulk_load(bt, entries)                                                      \
+    _bt_bulk_load(&(bt)->g, (entries)->data, (entries)->len, sizeof(*(entries)->data), \
+                  offsetof(typeof(*(entries)->data), key), offsetof(typeof(*(entries)->data), value))
+#define bt_free(bt) _bt_free(&(bt)->g)
+
+// iterators point at an entry, bt_iter_valid is false once they run past the last one
+#define bt_first(bt) _bt_first(&(bt)->g)
+#define bt_lower_bound(bt, k) ({                \
+    typeof(*(bt)->key_type) _bt_temp_key = (k); \
+    _bt_lower_bound(&(bt)->g, &_bt_temp_key);   \
+})
+#define bt_upper_bound(bt, k) ({                \
+    typeof(*(bt)->key_type) _bt_temp_key = (k); \
+    _bt_upper_bound(&(bt)->g, &_bt_temp_key);   \
+})
+#define bt_iter_valid(it) ((it).leaf != NULL)
+#define bt_iter_next(bt, it) _bt_iter_next(&(bt)->g, &(it))
+#define bt_iter_key(bt, it) ((typeof((bt)->key_type))_bt_iter_key(&(bt)->g, (it)))
+#define bt_iter_value(bt, it) ((typeof((bt)->value_type))_bt_iter_value(&(bt)->g, (it)))
+#define bt_foreach(bt, it) \
+    for (BT_Iter it = _bt_first(&(bt)->g); it.leaf != NULL; _bt_iter_next(&(bt)->g, &it))
+// visits the keys in [lo, hi) in order
+#define bt_range(bt, lo, hi, it)                                                                \
+    for (typeof(*(bt)->key_type) _bt_hi = (hi), *_bt_once = &_bt_hi; _bt_once; _bt_once = NULL) \
+        for (BT_Iter it = bt_lower_bound(bt, lo);                                               \
+             _bt_iter_before(&(bt)->g, it, &_bt_hi);                                            \
+             _bt_iter_next(&(bt)->g, &it))
+
+#endif // CHEST_ENABLE_BT
+
+#ifdef CHEST_ENABLE_DSU
+
+// disjoint-set union over the elements 0 .. n-1 (n < 2^31), stored in a single u32 per element:
+// a root has DSU_ROOT set and keeps the size of its set in the low bits, other elements keep their parent
+#define DSU_ROOT 0x80000000u
+
+// how many pairs ahead dsu_union_batch prefetches the elements of
+#ifndef CHEST_DSU_PREFETCH_DISTANCE
+#define CHEST_DSU_PREFETCH_DISTANCE 16
+#endif
+
+typedef struct
+{
+    DA_u32 nodes;
+    u64 components;
+} DSU;
+
+typedef struct
+{
+    u32 a;
+    u32 b;
+} DSU_Pair;
+
+bool _dsu_init(void *dsu, u64 n);
+u32 _dsu_find(void *dsu, u32 x);
+bool _dsu_union(void *dsu, u32 a, u32 b);
+u64 _dsu_union_batch(void *dsu, const DSU_Pair *pairs, u64 count, bool *merged);
+void _dsu_free(void *dsu);
+
+#define dsu_init(dsu, n) _dsu_init((dsu), (n))
+#define dsu_len(dsu) ((dsu)->nodes.len)
+#define dsu_components(dsu) ((dsu)->components)
+#define dsu_find(dsu, x) _dsu_find((dsu), (x))
+#define dsu_same(dsu, a, b) (_dsu_find((dsu), (a)) == _dsu_find((dsu), (b)))
+#define dsu_size(dsu, x) ((dsu)->nodes.data[_dsu_find((dsu), (x))] & ~DSU_ROOT)
+// true if a and b were in different sets
+#define dsu_union(dsu, a, b) _dsu_union((dsu), (a), (b))
+// unions every pair of a DA of DSU_Pair in order and returns the number of merges,
+// merged[i] (if not NULL) tells whether pair i merged two sets
+#define dsu_union_batch(dsu, pairs, merged) _dsu_union_batch((dsu), (pairs)->data, (pairs)->len, (merged))
+#define dsu_free(dsu) _dsu_free((dsu))
+
+#endif // CHEST_ENABLE_DSU
+
+#ifdef CHEST_IMPLEMENTATION
+
+#ifdef CHEST_ENABLE_DA
+
+void _da_init(void *da)
+{
+    DA_Generic *dag = (DA_Generic *)da;
+
+    dag->data = NULL;
+    dag->len = 0;
+    dag->cap = 0;
+}
+bool _da_reserve(void *da, u64 item_size, u64 new_cap)
+{
+    DA_Generic *dag = (DA_Generic *)da;
+    if (new_cap <= dag->cap)
+        return true;
+
+    void *new_data = realloc(dag->data, new_cap * item_size);
+    if (!new_data)
+        return false;
+
+    dag->data = new_data;
+    dag->cap = new_cap;
+
+    return true;
+}
+bool _da_resize(void *da, u64 item_size, u64 new_len)
+{
+    DA_Generic *dag = (DA_Generic *)da;
+
+    if (new_len > dag->cap)
+        if (!_da_reserve(da, item_size, new_len))
+            return false;
+
+    if (new_len > dag->len)
+    {
+        void *start = (u8 *)dag->data + (dag->len * item_size);
+        memset(start, 0, (new_len - dag->len) * item_size);
+    }
+    dag->len = new_len;
+
+    return true;
+}
+bool _da_push(void *da, u64 item_size, void *item)
+{
+    DA_Generic *dag = (DA_Generic *)da;
+
+    if (dag->len >= dag->cap)
+    {
+        u64 new_cap = dag->cap == 0 ? 8 : dag->cap * 2;
+        if (!_da_reserve(da, item_size, new_cap))
+            return false;
+    }
+
+    void *dest = (u8 *)dag->data + (dag->len * item_size);
+    memcpy(dest, item, item_size);
+    dag->len++;
+
+    return true;
+}
+bool _da_insert(void *da, u64 item_size, u64 index, void *item)
+{
+    DA_Generic *dag = (DA_Generic *)da;
+
+    if (index > dag->len)
+        return false;
+
+    if (dag->len >= dag->cap)
+    {
+        u64 new_cap = dag->cap == 0 ? 8 : dag->cap * 2;
+        if (!_da_reserve(da, item_size, new_cap))
+            return false;
+    }
+
+    if (index < dag->len)
+    {
+        void *src = (u8 *)dag->data + (index * item_size);
+        void *dest = (u8 *)src + item_size;
+        memmove(dest, src, (dag->len - index) * item_size);
+    }
+
+    void *insert_pos = (u8 *)dag->data + (index * item_size);
+    memcpy(insert_pos, item, item_size);
+    dag->len++;
+
+    return true;
+}
+bool _da_remove_at(void *da, u64 item_size, u64 index)
+{
+    DA_Generic *dag = (DA_Generic *)da;
+
+    if (index >= dag->len)
+        return false;
+
+    if (index < dag->len - 1)
+    {
         void *dest = (u8 *)dag->data + (index * item_size);
         void *src = (u8 *)dest + item_size;
         memmove(dest, src, (dag->len - index - 1) * item_size);
@@ -672,19 +1539,19 @@ void _ll_free(void *ll, size_t next_offset)
 
 #ifdef CHEST_ENABLE_HM
 
-static u64 hm_probe(HM_Generic *hm, void *data, size_t entry_size, size_t key_offset, size_t state_offset, u64 hash, void *key, bool *found)
+static u64 hm_probe(HM_Generic *hm, void *data, u64 cap, size_t entry_size, size_t key_offset, size_t state_offset, u64 hash, void *key, bool *found)
 {
-    if (!hm || !data || hm->cap == 0)
+    if (!hm || !data || cap == 0)
     {
         *found = false;
         return UINT64_MAX;
     }
 
-    u64 mask = hm->cap - 1;
+    u64 mask = cap - 1;
     u64 idx = hash & mask;
     u64 first_tombstone = UINT64_MAX;
 
-    for (u64 probes = 0; probes < hm->cap; probes++)
+    for (u64 probes = 0; probes < cap; probes++)
     {
         u8 *entry = (u8 *)data + idx * entry_size;
         HM_State *state = (HM_State *)(entry + state_offset);
@@ -716,35 +1583,11 @@ static u64 hm_probe(HM_Generic *hm, void *data, size_t entry_size, size_t key_of
 
     return first_tombstone;
 }
-static bool hm_grow(HM_Generic *hm, void **pdata, size_t entry_size, size_t key_offset, size_t val_offset, size_t state_offset)
-{
-    u64 new_cap = hm->cap != 0 ? hm->cap * 2 : 8;
-    return _hm_reserve(hm, pdata, entry_size, key_offset, val_offset, state_offset, new_cap);
-}
-bool _hm_init(void *hm, void **pdata, size_t entry_size, HM_HashFn hash_fn, HM_EqualFn equal_fn)
+static bool hm_resize(HM_Generic *hm, void **pdata, size_t entry_size, size_t key_offset, size_t state_offset, u64 new_cap)
 {
     HM_Generic *hmg = hm;
 
-    hmg->cap = 8;
-    hmg->len = 0;
-    hmg->hash_fn = hash_fn;
-    hmg->equal_fn = equal_fn;
-
-    void *dat = calloc(hmg->cap, entry_size);
-    if (!dat)
-        return false;
-
-    *pdata = dat;
-
-    return true;
-}
-bool _hm_reserve(void *hm, void **pdata, size_t entry_size, size_t key_offset, size_t val_offset, size_t state_offset, u64 new_cap)
-{
-    (void)val_offset;
-    HM_Generic *hmg = (HM_Generic *)hm;
-
-    if (new_cap <= hmg->cap)
-        return true;
+    _hm_finish_rehash(hmg, *pdata, entry_size, key_offset, state_offset);
 
     u64 cap = 1;
     while (cap < new_cap)
@@ -773,7 +1616,7 @@ bool _hm_reserve(void *hm, void **pdata, size_t entry_size, size_t key_offset, s
         u64 hash = hmg->hash_fn(key);
 
         bool found;
-        u64 idx = hm_probe(hmg, *pdata, entry_size, key_offset, state_offset, hash, key, &found);
+        u64 idx = hm_probe(hmg, *pdata, hmg->cap, entry_size, key_offset, state_offset, hash, key, &found);
         u8 *dst = (u8 *)*pdata + idx * entry_size;
 
         memcpy(dst, entry, entry_size);
@@ -784,85 +1627,221 @@ bool _hm_reserve(void *hm, void **pdata, size_t entry_size, size_t key_offset, s
 
     return true;
 }
-void *_hm_get(void *hm, void *data, size_t entry_size, size_t key_offset, size_t val_offset, size_t state_offset, u64 hash, void *key)
+static bool hm_grow(HM_Generic *hm, void **pdata, size_t entry_size, size_t key_offset, size_t val_offset, size_t state_offset)
 {
-    HM_Generic *hmg = hm;
+    u64 new_cap = hm->cap != 0 ? hm->cap * 2 : 8;
 
-    if (!data)
-        return NULL;
+    (void)val_offset;
 
-    bool found;
-    u64 idx = hm_probe(hmg, data, entry_size, key_offset, state_offset, hash, key, &found);
+    if (!hm->incremental || *pdata == NULL)
+        return hm_resize(hm, pdata, entry_size, key_offset, state_offset, new_cap);
 
-    if (!found)
-        return NULL;
+    // a resize can only start once the previous one has been completed
+    _hm_finish_rehash(hm, *pdata, entry_size, key_offset, state_offset);
 
-    u8 *entry = (u8 *)data + idx * entry_size;
-    return entry + val_offset;
+    void *new_data = calloc(new_cap, entry_size);
+    if (!new_data)
+        return false;
+
+    hm->old_data = *pdata;
+    hm->old_cap = hm->cap;
+    hm->rehash_pos = 0;
+
+    *pdata = new_data;
+    hm->cap = new_cap;
+
+    return true;
 }
-bool _hm_put(void *hm, void **pdata, size_t entry_size, size_t key_offset, size_t key_size, size_t val_offset, size_t val_size, size_t state_offset, u64 hash, void *key, void *val)
+static void hm_rehash_step(HM_Generic *hm, void *data, size_t entry_size, size_t key_offset, size_t state_offset, u64 steps)
 {
-    HM_Generic *hmg = hm;
-
-    if (*pdata == NULL)
-        if (!hm_grow(hmg, pdata, entry_size, key_offset, val_offset, state_offset))
-            return false;
+    if (!hm->old_data)
+        return;
 
-    bool found;
-    u64 idx = hm_probe(hmg, *pdata, entry_size, key_offset, state_offset, hash, key, &found);
+    u64 end = MIN(hm->rehash_pos + steps, hm->old_cap);
 
-    if (!found && (hmg->len + 1) * 4 >= hmg->cap * 3)
+    for (u64 i = hm->rehash_pos; i < end; i++)
     {
-        if (!hm_grow(hmg, pdata, entry_size, key_offset, val_offset, state_offset))
-            return false;
+        u8 *entry = (u8 *)hm->old_data + i * entry_size;
+        HM_State *state = (HM_State *)(entry + state_offset);
 
-        idx = hm_probe(hmg, *pdata, entry_size, key_offset, state_offset, hash, key, &found);
-    }
+        if (*state != HM_FILLED)
+            continue;
 
-    if (idx == UINT64_MAX)
-        return false;
+        void *key = entry + key_offset;
+        u64 hash = hm->hash_fn(key);
 
-    u8 *entry = (u8 *)*pdata + idx * entry_size;
-    HM_State *state = (HM_State *)(entry + state_offset);
+        // a key lives in exactly one of the two tables, so the probe cannot find it
+        bool found;
+        u64 idx = hm_probe(hm, data, hm->cap, entry_size, key_offset, state_offset, hash, key, &found);
+        u8 *dst = (u8 *)data + idx * entry_size;
 
-    if (!found)
-    {
-        memcpy(entry + key_offset, key, key_size);
-        hmg->len++;
-        *state = HM_FILLED;
+        memcpy(dst, entry, entry_size);
+        *(HM_State *)(dst + state_offset) = HM_FILLED;
     }
+    hm->rehash_pos = end;
 
-    memcpy(entry + val_offset, val, val_size);
-
-    return true;
+    if (hm->rehash_pos == hm->old_cap)
+    {
+        free(hm->old_data);
+        hm->old_data = NULL;
+        hm->old_cap = 0;
+        hm->rehash_pos = 0;
+    }
 }
-bool _hm_remove(void *hm, void *data, size_t entry_size, size_t key_offset, size_t state_offset, u64 hash, void *key)
+bool _hm_init(void *hm, void **pdata, size_t entry_size, HM_HashFn hash_fn, HM_EqualFn equal_fn)
 {
     HM_Generic *hmg = hm;
 
-    bool found;
-    u64 idx = hm_probe(hmg, data, entry_size, key_offset, state_offset, hash, key, &found);
+    hmg->cap = 8;
+    hmg->len = 0;
+    hmg->hash_fn = hash_fn;
+    hmg->equal_fn = equal_fn;
+    hmg->incremental = false;
+    hmg->old_data = NULL;
+    hmg->old_cap = 0;
+    hmg->rehash_pos = 0;
 
-    if (!found)
+    void *dat = calloc(hmg->cap, entry_size);
+    if (!dat)
         return false;
 
-    u8 *entry = (u8 *)data + idx * entry_size;
-    HM_State *state = (HM_State *)(entry + state_offset);
-
-    *state = HM_TOMBSTONE;
-    hmg->len--;
+    *pdata = dat;
 
     return true;
 }
-void _hm_clear(void *hm, void *data, size_t entry_size, size_t state_offset)
+bool _hm_reserve(void *hm, void **pdata, size_t entry_size, size_t key_offset, size_t val_offset, size_t state_offset, u64 new_cap)
 {
-    HM_Generic *hmg = hm;
+    (void)val_offset;
+    HM_Generic *hmg = (HM_Generic *)hm;
 
-    if (!data)
-        return;
+    // room for new_cap entries without crossing the 75% load that triggers a grow
+    u64 cap = 8;
+    while (new_cap * 4 >= cap * 3)
+        cap <<= 1;
 
-    for (u64 i = 0; i < hmg->cap; i++)
-    {
+    if (cap <= hmg->cap)
+        return true;
+
+    return hm_resize(hmg, pdata, entry_size, key_offset, state_offset, cap);
+}
+void *_hm_get(void *hm, void *data, size_t entry_size, size_t key_offset, size_t val_offset, size_t state_offset, u64 hash, void *key)
+{
+    HM_Generic *hmg = hm;
+
+    if (!data)
+        return NULL;
+
+    bool found;
+    u64 idx = hm_probe(hmg, data, hmg->cap, entry_size, key_offset, state_offset, hash, key, &found);
+
+    if (found)
+        return (u8 *)data + idx * entry_size + val_offset;
+
+    if (hmg->old_data)
+    {
+        idx = hm_probe(hmg, hmg->old_data, hmg->old_cap, entry_size, key_offset, state_offset, hash, key, &found);
+
+        if (found)
+            return (u8 *)hmg->old_data + idx * entry_size + val_offset;
+    }
+
+    return NULL;
+}
+void *_hm_entry(void *hm, void **pdata, size_t entry_size, size_t key_offset, size_t key_size, size_t val_offset, size_t val_size, size_t state_offset, u64 hash, void *key, bool *inserted)
+{
+    HM_Generic *hmg = hm;
+
+    if (inserted)
+        *inserted = false;
+
+    // grow before probing (as if k was missing), so the slot found by the probe stays valid
+    if (*pdata == NULL || (hmg->len + 1) * 4 >= hmg->cap * 3)
+        if (!hm_grow(hmg, pdata, entry_size, key_offset, val_offset, state_offset))
+            return NULL;
+
+    hm_rehash_step(hmg, *pdata, entry_size, key_offset, state_offset, CHEST_HM_REHASH_STEP);
+
+    bool found;
+    u64 idx = hm_probe(hmg, *pdata, hmg->cap, entry_size, key_offset, state_offset, hash, key, &found);
+
+    if (found)
+        return (u8 *)*pdata + idx * entry_size + val_offset;
+
+    if (hmg->old_data)
+    {
+        // not migrated yet, use it where it is
+        u64 old_idx = hm_probe(hmg, hmg->old_data, hmg->old_cap, entry_size, key_offset, state_offset, hash, key, &found);
+
+        if (found)
+            return (u8 *)hmg->old_data + old_idx * entry_size + val_offset;
+    }
+
+    if (idx == UINT64_MAX)
+        return NULL;
+
+    u8 *entry = (u8 *)*pdata + idx * entry_size;
+
+    memcpy(entry + key_offset, key, key_size);
+    memset(entry + val_offset, 0, val_size);
+    *(HM_State *)(entry + state_offset) = HM_FILLED;
+    hmg->len++;
+
+    if (inserted)
+        *inserted = true;
+
+    return entry + val_offset;
+}
+bool _hm_put(void *hm, void **pdata, size_t entry_size, size_t key_offset, size_t key_size, size_t val_offset, size_t val_size, size_t state_offset, u64 hash, void *key, void *val)
+{
+    void *dst = _hm_entry(hm, pdata, entry_size, key_offset, key_size, val_offset, val_size, state_offset, hash, key, NULL);
+    if (!dst)
+        return false;
+
+    memcpy(dst, val, val_size);
+
+    return true;
+}
+bool _hm_remove(void *hm, void *data, size_t entry_size, size_t key_offset, size_t state_offset, u64 hash, void *key)
+{
+    HM_Generic *hmg = hm;
+
+    hm_rehash_step(hmg, data, entry_size, key_offset, state_offset, CHEST_HM_REHASH_STEP);
+
+    bool found;
+    u64 idx = hm_probe(hmg, data, hmg->cap, entry_size, key_offset, state_offset, hash, key, &found);
+    u8 *table = data;
+
+    if (!found && hmg->old_data)
+    {
+        idx = hm_probe(hmg, hmg->old_data, hmg->old_cap, entry_size, key_offset, state_offset, hash, key, &found);
+        table = hmg->old_data;
+    }
+
+    if (!found)
+        return false;
+
+    u8 *entry = table + idx * entry_size;
+    HM_State *state = (HM_State *)(entry + state_offset);
+
+    *state = HM_TOMBSTONE;
+    hmg->len--;
+
+    return true;
+}
+void _hm_clear(void *hm, void *data, size_t entry_size, size_t state_offset)
+{
+    HM_Generic *hmg = hm;
+
+    free(hmg->old_data);
+    hmg->old_data = NULL;
+    hmg->old_cap = 0;
+    hmg->rehash_pos = 0;
+
+    if (!data)
+        return;
+
+    for (u64 i = 0; i < hmg->cap; i++)
+    {
         u8 *entry = (u8 *)data + i * entry_size;
         *(HM_State *)(entry + state_offset) = HM_EMPTY;
     }
@@ -874,13 +1853,1390 @@ void _hm_free(void *hm, void **pdata)
     HM_Generic *hmg = hm;
 
     free(*pdata);
+    free(hmg->old_data);
     *pdata = NULL;
+    hmg->old_data = NULL;
+    hmg->old_cap = 0;
+    hmg->rehash_pos = 0;
     hmg->cap = 0;
     hmg->len = 0;
 }
+void _hm_finish_rehash(void *hm, void *data, size_t entry_size, size_t key_offset, size_t state_offset)
+{
+    HM_Generic *hmg = hm;
+
+    if (hmg->old_data)
+        hm_rehash_step(hmg, data, entry_size, key_offset, state_offset, hmg->old_cap);
+}
 
 #endif // CHEST_ENABLE_HM
 
+#ifdef CHEST_ENABLE_HS
+
+static u64 hs_probe(HS_Generic *hs, void *keys, size_t key_size, u64 hash, void *key, bool *found)
+{
+    if (!hs || !keys || hs->cap == 0)
+    {
+        *found = false;
+        return UINT64_MAX;
+    }
+
+    u64 mask = hs->cap - 1;
+    u64 idx = hash & mask;
+    u64 first_tombstone = UINT64_MAX;
+
+    for (u64 probes = 0; probes < hs->cap; probes++)
+    {
+        HM_State state = hs->states[idx];
+
+        if (state == HM_EMPTY)
+        {
+            *found = false;
+            return (first_tombstone != UINT64_MAX) ? first_tombstone : idx;
+        }
+
+        if (state == HM_TOMBSTONE)
+        {
+            if (first_tombstone == UINT64_MAX)
+                first_tombstone = idx;
+        }
+        else if (hs->equal_fn((u8 *)keys + idx * key_size, key))
+        {
+            *found = true;
+            return idx;
+        }
+
+        idx = (idx + 1) & mask;
+    }
+    *found = false;
+
+    return first_tombstone;
+}
+static bool hs_grow(HS_Generic *hs, void **pkeys, size_t key_size)
+{
+    u64 new_cap = hs->cap != 0 ? hs->cap * 2 : 8;
+    return _hs_reserve(hs, pkeys, key_size, new_cap);
+}
+bool _hs_init(void *hs, void **pkeys, size_t key_size, HM_HashFn hash_fn, HM_EqualFn equal_fn)
+{
+    HS_Generic *hsg = hs;
+
+    hsg->cap = 8;
+    hsg->len = 0;
+    hsg->hash_fn = hash_fn;
+    hsg->equal_fn = equal_fn;
+
+    void *keys = malloc(hsg->cap * key_size);
+    HM_State *states = calloc(hsg->cap, sizeof(HM_State));
+    if (!keys || !states)
+    {
+        free(keys);
+        free(states);
+        return false;
+    }
+
+    *pkeys = keys;
+    hsg->states = states;
+
+    return true;
+}
+bool _hs_reserve(void *hs, void **pkeys, size_t key_size, u64 new_cap)
+{
+    HS_Generic *hsg = (HS_Generic *)hs;
+
+    if (new_cap <= hsg->cap)
+        return true;
+
+    u64 cap = 1;
+    while (cap < new_cap)
+        cap <<= 1;
+
+    u64 old_cap = hsg->cap;
+    void *old_keys = *pkeys;
+    HM_State *old_states = hsg->states;
+
+    void *new_keys = malloc(cap * key_size);
+    HM_State *new_states = calloc(cap, sizeof(HM_State));
+    if (!new_keys || !new_states)
+    {
+        free(new_keys);
+        free(new_states);
+        return false;
+    }
+
+    *pkeys = new_keys;
+    hsg->states = new_states;
+    hsg->cap = cap;
+    hsg->len = 0;
+
+    for (u64 i = 0; i < old_cap; i++)
+    {
+        if (old_states[i] != HM_FILLED)
+            continue;
+
+        void *key = (u8 *)old_keys + i * key_size;
+        u64 hash = hsg->hash_fn(key);
+
+        bool found;
+        u64 idx = hs_probe(hsg, *pkeys, key_size, hash, key, &found);
+
+        memcpy((u8 *)*pkeys + idx * key_size, key, key_size);
+        hsg->states[idx] = HM_FILLED;
+        hsg->len++;
+    }
+    free(old_keys);
+    free(old_states);
+
+    return true;
+}
+bool _hs_contains(void *hs, void *keys, size_t key_size, u64 hash, void *key)
+{
+    bool found;
+    hs_probe(hs, keys, key_size, hash, key, &found);
+
+    return found;
+}
+bool _hs_insert(void *hs, void **pkeys, size_t key_size, u64 hash, void *key)
+{
+    HS_Generic *hsg = hs;
+
+    if (*pkeys == NULL)
+        if (!hs_grow(hsg, pkeys, key_size))
+            return false;
+
+    bool found;
+    u64 idx = hs_probe(hsg, *pkeys, key_size, hash, key, &found);
+
+    if (found)
+        return true;
+
+    if ((hsg->len + 1) * 4 >= hsg->cap * 3)
+    {
+        if (!hs_grow(hsg, pkeys, key_size))
+            return false;
+
+        idx = hs_probe(hsg, *pkeys, key_size, hash, key, &found);
+    }
+
+    if (idx == UINT64_MAX)
+        return false;
+
+    memcpy((u8 *)*pkeys + idx * key_size, key, key_size);
+    hsg->states[idx] = HM_FILLED;
+    hsg->len++;
+
+    return true;
+}
+bool _hs_remove(void *hs, void *keys, size_t key_size, u64 hash, void *key)
+{
+    HS_Generic *hsg = hs;
+
+    bool found;
+    u64 idx = hs_probe(hsg, keys, key_size, hash, key, &found);
+
+    if (!found)
+        return false;
+
+    hsg->states[idx] = HM_TOMBSTONE;
+    hsg->len--;
+
+    return true;
+}
+bool _hs_union(void *dst, void **pdst_keys, void *src, void *src_keys, size_t key_size)
+{
+    HS_Generic *dstg = dst;
+    HS_Generic *srcg = src;
+
+    // a set united with itself stays the same, and the reserve below would free src_keys
+    if (dstg == srcg)
+        return true;
+
+    // size dst up front so the inserts below never rehash halfway through
+    u64 needed = (dstg->len + srcg->len) * 4 / 3 + 1;
+    if (!_hs_reserve(dstg, pdst_keys, key_size, needed))
+        return false;
+
+    for (u64 i = 0; i < srcg->cap; i++)
+    {
+        if (srcg->states[i] != HM_FILLED)
+            continue;
+
+        void *key = (u8 *)src_keys + i * key_size;
+        if (!_hs_insert(dstg, pdst_keys, key_size, dstg->hash_fn(key), key))
+            return false;
+    }
+
+    return true;
+}
+void _hs_intersect(void *dst, void *dst_keys, void *src, void *src_keys, size_t key_size)
+{
+    HS_Generic *dstg = dst;
+    HS_Generic *srcg = src;
+
+    for (u64 i = 0; i < dstg->cap; i++)
+    {
+        if (dstg->states[i] != HM_FILLED)
+            continue;
+
+        void *key = (u8 *)dst_keys + i * key_size;
+        if (!_hs_contains(srcg, src_keys, key_size, srcg->hash_fn(key), key))
+        {
+            dstg->states[i] = HM_TOMBSTONE;
+            dstg->len--;
+        }
+    }
+}
+void _hs_clear(void *hs)
+{
+    HS_Generic *hsg = hs;
+
+    if (!hsg->states)
+        return;
+
+    memset(hsg->states, HM_EMPTY, hsg->cap * sizeof(HM_State));
+    hsg->len = 0;
+}
+void _hs_free(void *hs, void **pkeys)
+{
+    HS_Generic *hsg = hs;
+
+    free(*pkeys);
+    free(hsg->states);
+    *pkeys = NULL;
+    hsg->states = NULL;
+    hsg->cap = 0;
+    hsg->len = 0;
+}
+
+#endif // CHEST_ENABLE_HS
+
+#ifdef CHEST_ENABLE_OHM
+
+static u64 ohm_probe(OHM_Generic *ohm, void *data, size_t entry_size, size_t key_offset, u64 hash, void *key, bool *found)
+{
+    if (!ohm || !ohm->slots || ohm->slot_cap == 0)
+    {
+        *found = false;
+        return UINT64_MAX;
+    }
+
+    u64 mask = ohm->slot_cap - 1;
+    u64 idx = hash & mask;
+    u64 first_tombstone = UINT64_MAX;
+
+    for (u64 probes = 0; probes < ohm->slot_cap; probes++)
+    {
+        u32 slot = ohm->slots[idx];
+
+        if (slot == OHM_SLOT_EMPTY)
+        {
+            *found = false;
+            return (first_tombstone != UINT64_MAX) ? first_tombstone : idx;
+        }
+
+        if (slot == OHM_SLOT_TOMBSTONE)
+        {
+            if (first_tombstone == UINT64_MAX)
+                first_tombstone = idx;
+        }
+        else
+        {
+            u8 *entry = (u8 *)data + (u64)(slot - OHM_SLOT_FIRST) * entry_size;
+            if (ohm->equal_fn(entry + key_offset, key))
+            {
+                *found = true;
+                return idx;
+            }
+        }
+
+        idx = (idx + 1) & mask;
+    }
+    *found = false;
+
+    return first_tombstone;
+}
+static bool ohm_rehash(OHM_Generic *ohm, void *data, size_t entry_size, size_t key_offset, u64 new_slot_cap)
+{
+    u32 *slots = calloc(new_slot_cap, sizeof(u32));
+    if (!slots)
+        return false;
+
+    free(ohm->slots);
+    ohm->slots = slots;
+    ohm->slot_cap = new_slot_cap;
+    ohm->tombstones = 0;
+
+    // the entries are unique, so each one just takes the first free slot
+    u64 mask = new_slot_cap - 1;
+    for (u64 i = 0; i < ohm->len; i++)
+    {
+        u8 *entry = (u8 *)data + i * entry_size;
+        u64 idx = ohm->hash_fn(entry + key_offset) & mask;
+
+        while (slots[idx] != OHM_SLOT_EMPTY)
+            idx = (idx + 1) & mask;
+
+        slots[idx] = (u32)(i + OHM_SLOT_FIRST);
+    }
+
+    return true;
+}
+bool _ohm_init(void *ohm, void **pdata, HM_HashFn hash_fn, HM_EqualFn equal_fn)
+{
+    OHM_Generic *ohmg = ohm;
+
+    ohmg->len = 0;
+    ohmg->cap = 0;
+    ohmg->slot_cap = 8;
+    ohmg->tombstones = 0;
+    ohmg->hash_fn = hash_fn;
+    ohmg->equal_fn = equal_fn;
+    *pdata = NULL;
+
+    ohmg->slots = calloc(ohmg->slot_cap, sizeof(u32));
+    if (!ohmg->slots)
+        return false;
+
+    return true;
+}
+bool _ohm_reserve(void *ohm, void **pdata, size_t entry_size, size_t key_offset, u64 new_cap)
+{
+    OHM_Generic *ohmg = ohm;
+
+    if (new_cap > UINT32_MAX - OHM_SLOT_FIRST)
+        return false;
+
+    if (new_cap > ohmg->cap)
+    {
+        void *new_data = realloc(*pdata, new_cap * entry_size);
+        if (!new_data)
+            return false;
+
+        *pdata = new_data;
+        ohmg->cap = new_cap;
+    }
+
+    // keep the table under 75% load even when all reserved entries are present
+    u64 slot_cap = ohmg->slot_cap != 0 ? ohmg->slot_cap : 8;
+    while (new_cap * 4 >= slot_cap * 3)
+        slot_cap <<= 1;
+
+    if (slot_cap > ohmg->slot_cap)
+        return ohm_rehash(ohmg, *pdata, entry_size, key_offset, slot_cap);
+
+    return true;
+}
+void *_ohm_get(void *ohm, void *data, size_t entry_size, size_t key_offset, size_t val_offset, u64 hash, void *key)
+{
+    OHM_Generic *ohmg = ohm;
+
+    bool found;
+    u64 idx = ohm_probe(ohmg, data, entry_size, key_offset, hash, key, &found);
+
+    if (!found)
+        return NULL;
+
+    u8 *entry = (u8 *)data + (u64)(ohmg->slots[idx] - OHM_SLOT_FIRST) * entry_size;
+    return entry + val_offset;
+}
+bool _ohm_put(void *ohm, void **pdata, size_t entry_size, size_t key_offset, size_t key_size, size_t val_offset, size_t val_size, u64 hash, void *key, void *val)
+{
+    OHM_Generic *ohmg = ohm;
+
+    // make room before probing, so the slot found below stays valid
+    if ((ohmg->len + ohmg->tombstones + 1) * 4 >= ohmg->slot_cap * 3)
+    {
+        u64 slot_cap = ohmg->slot_cap != 0 ? ohmg->slot_cap : 8;
+        while ((ohmg->len + 1) * 4 >= slot_cap * 3)
+            slot_cap <<= 1;
+
+        if (!ohm_rehash(ohmg, *pdata, entry_size, key_offset, slot_cap))
+            return false;
+    }
+
+    bool found;
+    u64 idx = ohm_probe(ohmg, *pdata, entry_size, key_offset, hash, key, &found);
+
+    if (idx == UINT64_MAX)
+        return false;
+
+    if (found)
+    {
+        u8 *entry = (u8 *)*pdata + (u64)(ohmg->slots[idx] - OHM_SLOT_FIRST) * entry_size;
+        memcpy(entry + val_offset, val, val_size);
+        return true;
+    }
+
+    if (ohmg->len >= ohmg->cap)
+    {
+        u64 new_cap = ohmg->cap == 0 ? 8 : ohmg->cap * 2;
+        if (new_cap > UINT32_MAX - OHM_SLOT_FIRST)
+            new_cap = UINT32_MAX - OHM_SLOT_FIRST;
+        if (new_cap <= ohmg->len)
+            return false;
+
+        void *new_data = realloc(*pdata, new_cap * entry_size);
+        if (!new_data)
+            return false;
+
+        *pdata = new_data;
+        ohmg->cap = new_cap;
+    }
+
+    u8 *entry = (u8 *)*pdata + ohmg->len * entry_size;
+    memcpy(entry + key_offset, key, key_size);
+    memcpy(entry + val_offset, val, val_size);
+
+    if (ohmg->slots[idx] == OHM_SLOT_TOMBSTONE)
+        ohmg->tombstones--;
+    ohmg->slots[idx] = (u32)(ohmg->len + OHM_SLOT_FIRST);
+    ohmg->len++;
+
+    return true;
+}
+bool _ohm_remove(void *ohm, void *data, size_t entry_size, size_t key_offset, u64 hash, void *key, bool keep_order)
+{
+    OHM_Generic *ohmg = ohm;
+
+    bool found;
+    u64 idx = ohm_probe(ohmg, data, entry_size, key_offset, hash, key, &found);
+
+    if (!found)
+        return false;
+
+    u32 removed = ohmg->slots[idx];
+    u32 last = (u32)(ohmg->len - 1 + OHM_SLOT_FIRST);
+    u8 *hole = (u8 *)data + (u64)(removed - OHM_SLOT_FIRST) * entry_size;
+
+    ohmg->slots[idx] = OHM_SLOT_TOMBSTONE;
+    ohmg->tombstones++;
+
+    if (removed != last)
+    {
+        if (keep_order)
+        {
+            memmove(hole, hole + entry_size, (u64)(last - removed) * entry_size);
+
+            for (u64 i = 0; i < ohmg->slot_cap; i++)
+                if (ohmg->slots[i] > removed)
+                    ohmg->slots[i]--;
+        }
+        else
+        {
+            u8 *moved = (u8 *)data + (u64)(last - OHM_SLOT_FIRST) * entry_size;
+            u64 mask = ohmg->slot_cap - 1;
+            u64 i = ohmg->hash_fn(moved + key_offset) & mask;
+
+            while (ohmg->slots[i] != last)
+                i = (i + 1) & mask;
+
+            ohmg->slots[i] = removed;
+            memcpy(hole, moved, entry_size);
+        }
+    }
+    ohmg->len--;
+
+    return true;
+}
+void _ohm_clear(void *ohm)
+{
+    OHM_Generic *ohmg = ohm;
+
+    if (ohmg->slots)
+        memset(ohmg->slots, 0, ohmg->slot_cap * sizeof(u32));
+
+    ohmg->len = 0;
+    ohmg->tombstones = 0;
+}
+void _ohm_free(void *ohm, void **pdata)
+{
+    OHM_Generic *ohmg = ohm;
+
+    free(*pdata);
+    free(ohmg->slots);
+    *pdata = NULL;
+    ohmg->slots = NULL;
+    ohmg->len = 0;
+    ohmg->cap = 0;
+    ohmg->slot_cap = 0;
+    ohmg->tombstones = 0;
+}
+
+#endif // CHEST_ENABLE_OHM
+
+#ifdef CHEST_ENABLE_SNAPSHOT
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+bool _snapshot_write(cstr path, Snapshot_Header *header, const void *data)
+{
+    FILE *file = fopen(path, "wb");
+    if (!file)
+        return false;
+
+    u8 head[SNAPSHOT_DATA_OFFSET] = {0};
+    memcpy(head, header, sizeof(*header));
+
+    u64 data_size = header->cap * header->item_size;
+    bool ok = fwrite(head, 1, sizeof(head), file) == sizeof(head) &&
+              (data_size == 0 || fwrite(data, 1, data_size, file) == data_size);
+
+    if (fclose(file) != 0)
+        ok = false;
+
+    return ok;
+}
+const void *_snapshot_open(cstr path, Snapshot_Header *expected, Snapshot *snap)
+{
+    snap->base = NULL;
+    snap->size = 0;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (u64)st.st_size < SNAPSHOT_DATA_OFFSET)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    void *base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+        return NULL;
+
+    const Snapshot_Header *header = base;
+    bool valid = header->magic == SNAPSHOT_MAGIC &&
+                 header->version == SNAPSHOT_VERSION &&
+                 header->kind == expected->kind &&
+                 header->item_size == expected->item_size &&
+                 header->hash_id == expected->hash_id &&
+                 header->len <= header->cap &&
+                 header->cap <= ((u64)st.st_size - SNAPSHOT_DATA_OFFSET) / header->item_size;
+
+    if (!valid)
+    {
+        munmap(base, (size_t)st.st_size);
+        return NULL;
+    }
+
+    *expected = *header;
+    snap->base = base;
+    snap->size = (u64)st.st_size;
+
+    return (const u8 *)base + SNAPSHOT_DATA_OFFSET;
+}
+void _snapshot_close(Snapshot *snap)
+{
+    if (snap->base)
+        munmap(snap->base, (size_t)snap->size);
+
+    snap->base = NULL;
+    snap->size = 0;
+}
+
+#ifdef CHEST_ENABLE_DA
+
+bool _da_save(void *da, u64 item_size, cstr path)
+{
+    DA_Generic *dag = (DA_Generic *)da;
+
+    Snapshot_Header header = {
+        .magic = SNAPSHOT_MAGIC,
+        .version = SNAPSHOT_VERSION,
+        .kind = SNAPSHOT_DA,
+        .item_size = item_size,
+        .len = dag->len,
+        .cap = dag->len,
+        .hash_id = 0,
+    };
+
+    return _snapshot_write(path, &header, dag->data);
+}
+bool _da_mmap(void *da, u64 item_size, cstr path, Snapshot *snap)
+{
+    DA_Generic *dag = (DA_Generic *)da;
+
+    Snapshot_Header header = {.kind = SNAPSHOT_DA, .item_size = item_size, .hash_id = 0};
+    const void *data = _snapshot_open(path, &header, snap);
+    if (!data)
+        return false;
+
+    dag->data = (void *)data;
+    dag->len = header.len;
+    dag->cap = header.len;
+
+    return true;
+}
+
+#endif // CHEST_ENABLE_DA
+
+#ifdef CHEST_ENABLE_HM
+
+bool _hm_save(void *hm, void *data, size_t entry_size, u64 hash_id, cstr path)
+{
+    HM_Generic *hmg = hm;
+
+    Snapshot_Header header = {
+        .magic = SNAPSHOT_MAGIC,
+        .version = SNAPSHOT_VERSION,
+        .kind = SNAPSHOT_HM,
+        .item_size = entry_size,
+        .len = hmg->len,
+        .cap = data ? hmg->cap : 0,
+        .hash_id = hash_id,
+    };
+
+    return _snapshot_write(path, &header, data);
+}
+bool _hm_mmap(void *hm, void **pdata, size_t entry_size, HM_HashFn hash_fn, HM_EqualFn equal_fn, u64 hash_id, cstr path, Snapshot *snap)
+{
+    HM_Generic *hmg = hm;
+
+    Snapshot_Header header = {.kind = SNAPSHOT_HM, .item_size = entry_size, .hash_id = hash_id};
+    const void *data = _snapshot_open(path, &header, snap);
+    if (!data)
+        return false;
+
+    // the probing relies on a power of two capacity
+    if (header.cap == 0 || (header.cap & (header.cap - 1)) != 0)
+    {
+        _snapshot_close(snap);
+        return false;
+    }
+
+    hmg->cap = header.cap;
+    hmg->len = header.len;
+    hmg->hash_fn = hash_fn;
+    hmg->equal_fn = equal_fn;
+    hmg->incremental = false;
+    hmg->old_data = NULL;
+    hmg->old_cap = 0;
+    hmg->rehash_pos = 0;
+    *pdata = (void *)data;
+
+    return true;
+}
+
+#endif // CHEST_ENABLE_HM
+
+#endif // CHEST_ENABLE_SNAPSHOT
+
+#ifdef CHEST_ENABLE_CSR
+
+bool _csr_build(void *csr, u64 n, const void *edges, u64 edge_count, size_t edge_size, size_t weight_offset, size_t weight_size)
+{
+    CSR_Generic *g = csr;
+
+    g->n = n;
+    g->m = edge_count;
+    g->offsets = calloc(n + 1, sizeof(u64));
+    g->targets = malloc(MAX(edge_count, 1) * sizeof(u32));
+    g->weights = weight_size ? malloc(MAX(edge_count, 1) * weight_size) : NULL;
+
+    if (!g->offsets || !g->targets || (weight_size && !g->weights))
+    {
+        _csr_free(g);
+        return false;
+    }
+
+    // first pass: count the out-degrees and turn them into start offsets
+    for (u64 i = 0; i < edge_count; i++)
+    {
+        const CSR_Edge *e = (const void *)((const u8 *)edges + i * edge_size);
+        if (e->from >= n || e->to >= n)
+        {
+            _csr_free(g);
+            return false;
+        }
+        g->offsets[e->from + 1]++;
+    }
+    for (u64 u = 0; u < n; u++)
+        g->offsets[u + 1] += g->offsets[u];
+
+    // second pass: scatter the edges, offsets[u] serves as the insert position of u for now
+    for (u64 i = 0; i < edge_count; i++)
+    {
+        const u8 *e = (const u8 *)edges + i * edge_size;
+        u64 pos = g->offsets[((const CSR_Edge *)(const void *)e)->from]++;
+
+        g->targets[pos] = ((const CSR_Edge *)(const void *)e)->to;
+        if (weight_size)
+            memcpy((u8 *)g->weights + pos * weight_size, e + weight_offset, weight_size);
+    }
+
+    // every offset has been moved to the start of the next node, shift them back
+    memmove(g->offsets + 1, g->offsets, n * sizeof(u64));
+    g->offsets[0] = 0;
+
+    return true;
+}
+bool _csr_reverse(void *dst, const void *src, size_t weight_size)
+{
+    CSR_Generic *d = dst;
+    const CSR_Generic *s = src;
+
+    d->n = s->n;
+    d->m = s->m;
+    d->offsets = calloc(s->n + 1, sizeof(u64));
+    d->targets = malloc(MAX(s->m, 1) * sizeof(u32));
+    d->weights = weight_size ? malloc(MAX(s->m, 1) * weight_size) : NULL;
+
+    if (!d->offsets || !d->targets || (weight_size && !d->weights))
+    {
+        _csr_free(d);
+        return false;
+    }
+
+    for (u64 e = 0; e < s->m; e++)
+        d->offsets[s->targets[e] + 1]++;
+    for (u64 u = 0; u < s->n; u++)
+        d->offsets[u + 1] += d->offsets[u];
+
+    for (u64 u = 0; u < s->n; u++)
+    {
+        for (u64 e = s->offsets[u]; e < s->offsets[u + 1]; e++)
+        {
+            u64 pos = d->offsets[s->targets[e]]++;
+
+            d->targets[pos] = (u32)u;
+            if (weight_size)
+                memcpy((u8 *)d->weights + pos * weight_size, (const u8 *)s->weights + e * weight_size, weight_size);
+        }
+    }
+
+    memmove(d->offsets + 1, d->offsets, s->n * sizeof(u64));
+    d->offsets[0] = 0;
+
+    return true;
+}
+void _csr_free(void *csr)
+{
+    CSR_Generic *g = csr;
+
+    free(g->offsets);
+    free(g->targets);
+    free(g->weights);
+    g->offsets = NULL;
+    g->targets = NULL;
+    g->weights = NULL;
+    g->n = 0;
+    g->m = 0;
+}
+
+#endif // CHEST_ENABLE_CSR
+
+#ifdef CHEST_ENABLE_BT
+
+#define BT_KEY(bt, node, i) ((u8 *)(node) + BT_KEYS_OFFSET + (i) * (bt)->key_size)
+#define BT_VALUE(bt, node, i) ((u8 *)(node) + (bt)->payload_offset + (i) * (bt)->val_size)
+#define BT_CHILDREN(bt, node) ((BT_Node **)((u8 *)(node) + (bt)->payload_offset))
+// fewest keys a non-root node may hold, what is left over by a split
+#define BT_MIN_LEAF(bt) ((bt)->order / 2)
+#define BT_MIN_INTERNAL(bt) (((bt)->order - 1) / 2)
+
+static BT_Node *bt_node_new(BT_Generic *bt, bool leaf)
+{
+    u64 payload_size = leaf ? bt->order * bt->val_size : (bt->order + 1) * sizeof(BT_Node *);
+
+    BT_Node *node = malloc(bt->payload_offset + payload_size);
+    if (!node)
+        return NULL;
+
+    node->next = NULL;
+    node->len = 0;
+    node->leaf = leaf;
+
+    return node;
+}
+static void bt_node_free(BT_Generic *bt, BT_Node *node)
+{
+    if (!node->leaf)
+        for (u64 i = 0; i <= node->len; i++)
+            bt_node_free(bt, BT_CHILDREN(bt, node)[i]);
+
+    free(node);
+}
+// index of the first key >= key (or > key if upper)
+static u64 bt_search(BT_Generic *bt, BT_Node *node, const void *key, bool upper)
+{
+    u64 lo = 0, hi = node->len;
+    while (lo < hi)
+    {
+        u64 mid = (lo + hi) / 2;
+        i32 c = bt->cmp_fn(BT_KEY(bt, node, mid), key);
+
+        if (c < 0 || (upper && c == 0))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+// splits the full i-th child of a non-full parent, the upper half moves into a new right sibling
+static bool bt_split_child(BT_Generic *bt, BT_Node *parent, u64 i)
+{
+    BT_Node *child = BT_CHILDREN(bt, parent)[i];
+    BT_Node *right = bt_node_new(bt, child->leaf);
+    if (!right)
+        return false;
+
+    u64 mid = bt->order / 2;
+    void *separator;
+
+    if (child->leaf)
+    {
+        // the separator is a copy of the first key of the right leaf
+        right->len = child->len - mid;
+        memcpy(BT_KEY(bt, right, 0), BT_KEY(bt, child, mid), right->len * bt->key_size);
+        memcpy(BT_VALUE(bt, right, 0), BT_VALUE(bt, child, mid), right->len * bt->val_size);
+
+        right->next = child->next;
+        child->next = right;
+        separator = BT_KEY(bt, right, 0);
+    }
+    else
+    {
+        // the middle key moves up into the parent
+        right->len = child->len - mid - 1;
+        memcpy(BT_KEY(bt, right, 0), BT_KEY(bt, child, mid + 1), right->len * bt->key_size);
+        memcpy(BT_CHILDREN(bt, right), BT_CHILDREN(bt, child) + mid + 1, (right->len + 1) * sizeof(BT_Node *));
+
+        separator = BT_KEY(bt, child, mid);
+    }
+    child->len = mid;
+
+    BT_Node **children = BT_CHILDREN(bt, parent);
+    memmove(BT_KEY(bt, parent, i + 1), BT_KEY(bt, parent, i), (parent->len - i) * bt->key_size);
+    memcpy(BT_KEY(bt, parent, i), separator, bt->key_size);
+    memmove(children + i + 2, children + i + 1, (parent->len - i) * sizeof(BT_Node *));
+    children[i + 1] = right;
+    parent->len++;
+
+    return true;
+}
+static BT_Node *bt_find_leaf(BT_Generic *bt, const void *key)
+{
+    BT_Node *node = bt->root;
+    if (!node)
+        return NULL;
+
+    while (!node->leaf)
+        node = BT_CHILDREN(bt, node)[bt_search(bt, node, key, true)];
+
+    return node;
+}
+void _bt_init(void *bt, u64 key_size, u64 val_size, BT_CmpFn cmp_fn)
+{
+    BT_Generic *btg = bt;
+
+    btg->root = NULL;
+    btg->len = 0;
+    btg->cmp_fn = cmp_fn;
+    btg->key_size = key_size;
+    btg->val_size = val_size;
+    btg->order = CLAMP(CHEST_BT_NODE_KEY_BYTES / key_size, 4, UINT16_MAX - 1);
+    btg->payload_offset = ALIGN_UP_POW2(BT_KEYS_OFFSET + btg->order * key_size, 16);
+}
+void *_bt_get(void *bt, const void *key)
+{
+    BT_Generic *btg = bt;
+
+    BT_Node *leaf = bt_find_leaf(btg, key);
+    if (!leaf)
+        return NULL;
+
+    u64 i = bt_search(btg, leaf, key, false);
+    if (i < leaf->len && btg->cmp_fn(BT_KEY(btg, leaf, i), key) == 0)
+        return BT_VALUE(btg, leaf, i);
+
+    return NULL;
+}
+void *_bt_entry(void *bt, const void *key, bool *inserted)
+{
+    BT_Generic *btg = bt;
+
+    if (inserted)
+        *inserted = false;
+
+    if (!btg->root)
+    {
+        btg->root = bt_node_new(btg, true);
+        if (!btg->root)
+            return NULL;
+    }
+
+    // split full nodes on the way down, so there is always room for a separator in the parent
+    BT_Node *root = btg->root;
+    if (root->len == btg->order)
+    {
+        BT_Node *new_root = bt_node_new(btg, false);
+        if (!new_root)
+            return NULL;
+
+        BT_CHILDREN(btg, new_root)[0] = root;
+        if (!bt_split_child(btg, new_root, 0))
+        {
+            free(new_root);
+            return NULL;
+        }
+        btg->root = new_root;
+    }
+
+    BT_Node *node = btg->root;
+    while (!node->leaf)
+    {
+        u64 i = bt_search(btg, node, key, true);
+
+        if (BT_CHILDREN(btg, node)[i]->len == btg->order)
+        {
+            if (!bt_split_child(btg, node, i))
+                return NULL;
+
+            if (btg->cmp_fn(key, BT_KEY(btg, node, i)) >= 0)
+                i++;
+        }
+        node = BT_CHILDREN(btg, node)[i];
+    }
+
+    u64 i = bt_search(btg, node, key, false);
+    if (i < node->len && btg->cmp_fn(BT_KEY(btg, node, i), key) == 0)
+        return BT_VALUE(btg, node, i);
+
+    memmove(BT_KEY(btg, node, i + 1), BT_KEY(btg, node, i), (node->len - i) * btg->key_size);
+    memmove(BT_VALUE(btg, node, i + 1), BT_VALUE(btg, node, i), (node->len - i) * btg->val_size);
+    memcpy(BT_KEY(btg, node, i), key, btg->key_size);
+    memset(BT_VALUE(btg, node, i), 0, btg->val_size);
+    node->len++;
+    btg->len++;
+
+    if (inserted)
+        *inserted = true;
+
+    return BT_VALUE(btg, node, i);
+}
+bool _bt_put(void *bt, const void *key, const void *val)
+{
+    BT_Generic *btg = bt;
+
+    void *dst = _bt_entry(btg, key, NULL);
+    if (!dst)
+        return false;
+
+    memcpy(dst, val, btg->val_size);
+
+    return true;
+}
+// the i-th child of parent dropped below the minimum, refill it from a sibling or merge it with one
+static void bt_fix_child(BT_Generic *bt, BT_Node *parent, u64 i)
+{
+    BT_Node **children = BT_CHILDREN(bt, parent);
+    BT_Node *child = children[i];
+    BT_Node *left = i > 0 ? children[i - 1] : NULL;
+    BT_Node *right = i < parent->len ? children[i + 1] : NULL;
+    u64 min = child->leaf ? BT_MIN_LEAF(bt) : BT_MIN_INTERNAL(bt);
+
+    if (left && left->len > min)
+    {
+        // rotate the last entry of the left sibling into the front of child
+        memmove(BT_KEY(bt, child, 1), BT_KEY(bt, child, 0), child->len * bt->key_size);
+
+        if (child->leaf)
+        {
+            memmove(BT_VALUE(bt, child, 1), BT_VALUE(bt, child, 0), child->len * bt->val_size);
+            memcpy(BT_KEY(bt, child, 0), BT_KEY(bt, left, left->len - 1), bt->key_size);
+            memcpy(BT_VALUE(bt, child, 0), BT_VALUE(bt, left, left->len - 1), bt->val_size);
+            memcpy(BT_KEY(bt, parent, i - 1), BT_KEY(bt, child, 0), bt->key_size);
+        }
+        else
+        {
+            memmove(BT_CHILDREN(bt, child) + 1, BT_CHILDREN(bt, child), (child->len + 1) * sizeof(BT_Node *));
+            memcpy(BT_KEY(bt, child, 0), BT_KEY(bt, parent, i - 1), bt->key_size);
+            BT_CHILDREN(bt, child)[0] = BT_CHILDREN(bt, left)[left->len];
+            memcpy(BT_KEY(bt, parent, i - 1), BT_KEY(bt, left, left->len - 1), bt->key_size);
+        }
+        left->len--;
+        child->len++;
+
+        return;
+    }
+
+    if (right && right->len > min)
+    {
+        // rotate the first entry of the right sibling onto the end of child
+        if (child->leaf)
+        {
+            memcpy(BT_KEY(bt, child, child->len), BT_KEY(bt, right, 0), bt->key_size);
+            memcpy(BT_VALUE(bt, child, child->len), BT_VALUE(bt, right, 0), bt->val_size);
+            memmove(BT_VALUE(bt, right, 0), BT_VALUE(bt, right, 1), (right->len - 1) * bt->val_size);
+        }
+        else
+        {
+            memcpy(BT_KEY(bt, child, child->len), BT_KEY(bt, parent, i), bt->key_size);
+            BT_CHILDREN(bt, child)[child->len + 1] = BT_CHILDREN(bt, right)[0];
+            memcpy(BT_KEY(bt, parent, i), BT_KEY(bt, right, 0), bt->key_size);
+            memmove(BT_CHILDREN(bt, right), BT_CHILDREN(bt, right) + 1, right->len * sizeof(BT_Node *));
+        }
+        memmove(BT_KEY(bt, right, 0), BT_KEY(bt, right, 1), (right->len - 1) * bt->key_size);
+        right->len--;
+        child->len++;
+
+        if (child->leaf)
+            memcpy(BT_KEY(bt, parent, i), BT_KEY(bt, right, 0), bt->key_size);
+
+        return;
+    }
+
+    // both siblings are at the minimum, so the two nodes fit into one: merge the right one into the left one
+    u64 sep = left ? i - 1 : i;
+    BT_Node *dst = children[sep];
+    BT_Node *src = children[sep + 1];
+
+    if (dst->leaf)
+    {
+        memcpy(BT_KEY(bt, dst, dst->len), BT_KEY(bt, src, 0), src->len * bt->key_size);
+        memcpy(BT_VALUE(bt, dst, dst->len), BT_VALUE(bt, src, 0), src->len * bt->val_size);
+        dst->len += src->len;
+        dst->next = src->next;
+    }
+    else
+    {
+        // the separator comes down between the two halves
+        memcpy(BT_KEY(bt, dst, dst->len), BT_KEY(bt, parent, sep), bt->key_size);
+        memcpy(BT_KEY(bt, dst, dst->len + 1), BT_KEY(bt, src, 0), src->len * bt->key_size);
+        memcpy(BT_CHILDREN(bt, dst) + dst->len + 1, BT_CHILDREN(bt, src), (src->len + 1) * sizeof(BT_Node *));
+        dst->len += src->len + 1;
+    }
+    free(src);
+
+    memmove(BT_KEY(bt, parent, sep), BT_KEY(bt, parent, sep + 1), (parent->len - sep - 1) * bt->key_size);
+    memmove(children + sep + 1, children + sep + 2, (parent->len - sep - 1) * sizeof(BT_Node *));
+    parent->len--;
+}
+static bool bt_remove_from(BT_Generic *bt, BT_Node *node, const void *key)
+{
+    if (node->leaf)
+    {
+        u64 i = bt_search(bt, node, key, false);
+        if (i >= node->len || bt->cmp_fn(BT_KEY(bt, node, i), key) != 0)
+            return false;
+
+        memmove(BT_KEY(bt, node, i), BT_KEY(bt, node, i + 1), (node->len - i - 1) * bt->key_size);
+        memmove(BT_VALUE(bt, node, i), BT_VALUE(bt, node, i + 1), (node->len - i - 1) * bt->val_size);
+        node->len--;
+
+        return true;
+    }
+
+    u64 i = bt_search(bt, node, key, true);
+    BT_Node *child = BT_CHILDREN(bt, node)[i];
+
+    if (!bt_remove_from(bt, child, key))
+        return false;
+
+    if (child->len < (child->leaf ? BT_MIN_LEAF(bt) : BT_MIN_INTERNAL(bt)))
+        bt_fix_child(bt, node, i);
+
+    return true;
+}
+bool _bt_remove(void *bt, const void *key)
+{
+    BT_Generic *btg = bt;
+
+    BT_Node *root = btg->root;
+    if (!root || !bt_remove_from(btg, root, key))
+        return false;
+
+    btg->len--;
+
+    // the root is exempt from the minimum, it only goes away once it is empty
+    if (root->len == 0)
+    {
+        btg->root = root->leaf ? NULL : BT_CHILDREN(btg, root)[0];
+        free(root);
+    }
+
+    return true;
+}
+bool _bt_bulk_load(void *bt, const void *entries, u64 count, size_t entry_size, size_t key_offset, size_t val_offset)
+{
+    BT_Generic *btg = bt;
+
+    if (btg->len != 0)
+        return false;
+
+    for (u64 i = 1; i < count; i++)
+    {
+        const u8 *prev = (const u8 *)entries + (i - 1) * entry_size;
+        if (btg->cmp_fn(prev + key_offset, prev + entry_size + key_offset) >= 0)
+            return false;
+    }
+
+    _bt_free(btg);
+    if (count == 0)
+        return true;
+
+    // spread the entries evenly over as few leaves as possible, which keeps every leaf at least half full
+    u64 nodes = (count + btg->order - 1) / btg->order;
+
+    BT_Node **level = malloc(nodes * sizeof(BT_Node *));
+    u8 **min_keys = malloc(nodes * sizeof(u8 *));
+    if (!level || !min_keys)
+    {
+        free(level);
+        free(min_keys);
+        return false;
+    }
+
+    for (u64 l = 0; l < nodes; l++)
+    {
+        BT_Node *leaf = bt_node_new(btg, true);
+        if (!leaf)
+        {
+            for (u64 j = 0; j < l; j++)
+                free(level[j]);
+            free(level);
+            free(min_keys);
+            return false;
+        }
+
+        u64 start = l * (count / nodes) + MIN(l, count % nodes);
+        leaf->len = (u16)(count / nodes + (l < count % nodes));
+
+        for (u64 j = 0; j < leaf->len; j++)
+        {
+            const u8 *entry = (const u8 *)entries + (start + j) * entry_size;
+            memcpy(BT_KEY(btg, leaf, j), entry + key_offset, btg->key_size);
+            memcpy(BT_VALUE(btg, leaf, j), entry + val_offset, btg->val_size);
+        }
+
+        if (l > 0)
+            level[l - 1]->next = leaf;
+        level[l] = leaf;
+        min_keys[l] = BT_KEY(btg, leaf, 0);
+    }
+
+    // build the internal levels bottom-up, each parent takes the next run of children
+    while (nodes > 1)
+    {
+        u64 parents = (nodes + btg->order) / (btg->order + 1);
+
+        for (u64 p = 0; p < parents; p++)
+        {
+            u64 first = p * (nodes / parents) + MIN(p, nodes % parents);
+            u64 children = nodes / parents + (p < nodes % parents);
+
+            BT_Node *parent = bt_node_new(btg, false);
+            if (!parent)
+            {
+                // parents before p own the children before first, the rest are still loose
+                for (u64 j = 0; j < p; j++)
+                    bt_node_free(btg, level[j]);
+                for (u64 j = first; j < nodes; j++)
+                    bt_node_free(btg, level[j]);
+                free(level);
+                free(min_keys);
+                return false;
+            }
+
+            parent->len = (u16)(children - 1);
+            for (u64 c = 0; c < children; c++)
+            {
+                BT_CHILDREN(btg, parent)[c] = level[first + c];
+                if (c > 0)
+                    memcpy(BT_KEY(btg, parent, c - 1), min_keys[first + c], btg->key_size);
+            }
+
+            // p <= first, so nothing that is still needed gets overwritten
+            level[p] = parent;
+            min_keys[p] = min_keys[first];
+        }
+        nodes = parents;
+    }
+
+    btg->root = level[0];
+    btg->len = count;
+    free(level);
+    free(min_keys);
+
+    return true;
+}
+// moves the iterator onto the next leaf once it runs past the end of the current one
+static void bt_iter_settle(BT_Iter *it)
+{
+    while (it->leaf && it->idx >= ((BT_Node *)it->leaf)->len)
+    {
+        it->leaf = ((BT_Node *)it->leaf)->next;
+        it->idx = 0;
+    }
+}
+BT_Iter _bt_first(void *bt)
+{
+    BT_Generic *btg = bt;
+
+    BT_Node *node = btg->root;
+    while (node && !node->leaf)
+        node = BT_CHILDREN(btg, node)[0];
+
+    BT_Iter it = {node, 0};
+    bt_iter_settle(&it);
+
+    return it;
+}
+BT_Iter _bt_lower_bound(void *bt, const void *key)
+{
+    BT_Generic *btg = bt;
+
+    BT_Node *leaf = bt_find_leaf(btg, key);
+    BT_Iter it = {leaf, leaf ? bt_search(btg, leaf, key, false) : 0};
+    bt_iter_settle(&it);
+
+    return it;
+}
+BT_Iter _bt_upper_bound(void *bt, const void *key)
+{
+    BT_Generic *btg = bt;
+
+    BT_Node *leaf = bt_find_leaf(btg, key);
+    BT_Iter it = {leaf, leaf ? bt_search(btg, leaf, key, true) : 0};
+    bt_iter_settle(&it);
+
+    return it;
+}
+void _bt_iter_next(void *bt, BT_Iter *it)
+{
+    (void)bt;
+
+    it->idx++;
+    bt_iter_settle(it);
+}
+void *_bt_iter_key(void *bt, BT_Iter it)
+{
+    return BT_KEY((BT_Generic *)bt, it.leaf, it.idx);
+}
+void *_bt_iter_value(void *bt, BT_Iter it)
+{
+    return BT_VALUE((BT_Generic *)bt, it.leaf, it.idx);
+}
+bool _bt_iter_before(void *bt, BT_Iter it, const void *key)
+{
+    BT_Generic *btg = bt;
+
+    return it.leaf && btg->cmp_fn(BT_KEY(btg, it.leaf, it.idx), key) < 0;
+}
+void _bt_free(void *bt)
+{
+    BT_Generic *btg = bt;
+
+    if (btg->root)
+        bt_node_free(btg, btg->root);
+
+    btg->root = NULL;
+    btg->len = 0;
+}
+
+#undef BT_KEY
+#undef BT_VALUE
+#undef BT_CHILDREN
+#undef BT_MIN_LEAF
+#undef BT_MIN_INTERNAL
+
+#endif // CHEST_ENABLE_BT
+
+#ifdef CHEST_ENABLE_DSU
+
+bool _dsu_init(void *dsu, u64 n)
+{
+    DSU *d = dsu;
+
+    da_init(&d->nodes);
+    d->components = 0;
+
+    if (n >= DSU_ROOT || !da_resize(&d->nodes, n))
+        return false;
+
+    for (u64 i = 0; i < n; i++)
+        d->nodes.data[i] = DSU_ROOT | 1;
+    d->components = n;
+
+    return true;
+}
+u32 _dsu_find(void *dsu, u32 x)
+{
+    u32 *nodes = ((DSU *)dsu)->nodes.data;
+
+    // path halving: every visited element is pointed at its grandparent
+    while (!(nodes[x] & DSU_ROOT))
+    {
+        u32 parent = nodes[x];
+        if (!(nodes[parent] & DSU_ROOT))
+            nodes[x] = nodes[parent];
+        x = nodes[x];
+    }
+
+    return x;
+}
+bool _dsu_union(void *dsu, u32 a, u32 b)
+{
+    DSU *d = dsu;
+    u32 *nodes = d->nodes.data;
+
+    a = _dsu_find(d, a);
+    b = _dsu_find(d, b);
+    if (a == b)
+        return false;
+
+    // union by size: the smaller tree goes under the larger root
+    u32 size_a = nodes[a] & ~DSU_ROOT;
+    u32 size_b = nodes[b] & ~DSU_ROOT;
+    if (size_a < size_b)
+        SWAP(u32, a, b);
+
+    nodes[a] = DSU_ROOT | (size_a + size_b);
+    nodes[b] = a;
+    d->components--;
+
+    return true;
+}
+u64 _dsu_union_batch(void *dsu, const DSU_Pair *pairs, u64 count, bool *merged)
+{
+    DSU *d = dsu;
+    u64 merges = 0;
+
+    // on large sets almost every access misses the cache, so the elements of the upcoming pairs are requested early
+    for (u64 i = 0; i < count; i++)
+    {
+        if (i + CHEST_DSU_PREFETCH_DISTANCE < count)
+        {
+            const DSU_Pair *ahead = &pairs[i + CHEST_DSU_PREFETCH_DISTANCE];
+            __builtin_prefetch(&d->nodes.data[ahead->a], 1);
+            __builtin_prefetch(&d->nodes.data[ahead->b], 1);
+        }
+
+        bool m = _dsu_union(d, pairs[i].a, pairs[i].b);
+        if (merged)
+            merged[i] = m;
+        merges += m;
+    }
+
+    return merges;
+}
+void _dsu_free(void *dsu)
+{
+    DSU *d = dsu;
+
+    da_free(&d->nodes);
+    d->components = 0;
+}
+
+#endif // CHEST_ENABLE_DSU
+
 #endif // CHEST_IMPLEMENTATION
 
 #endif // CHEST_H
\ No newline at end of file